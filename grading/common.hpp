@@ -26,6 +26,7 @@
 // External headers
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <condition_variable>
 #include <cstddef>
 #include <cstdint>
@@ -199,6 +200,87 @@ public:
     }
 };
 
+/** Log-linear histogram class (HDR-style), for non-negative integer values with a bounded relative error.
+**/
+class Histogram final {
+public:
+    /** Value and count classes.
+    **/
+    using Value = uint_fast64_t;
+    using Count = uint_fast64_t;
+    constexpr static auto sub_bits  = 5u;                              // Log2 of the number of buckets per power of two (relative error below 2^-sub_bits)
+    constexpr static auto sub_count = size_t{1} << sub_bits;           // Number of buckets per power of two
+    constexpr static auto nbbuckets = (64 - sub_bits + 1) * sub_count; // Number of buckets to cover all the values
+private:
+    Count buckets[nbbuckets]; // Number of recorded values per bucket
+    Count total;              // Total number of recorded values
+private:
+    /** Get the bucket of a value.
+     * @param value Value to locate
+     * @return Bucket index
+    **/
+    static size_t index(Value value) noexcept {
+        if (value < sub_count) // Exact buckets
+            return value;
+        auto const shift = static_cast<size_t>(63 - __builtin_clzll(value)) - sub_bits;
+        return ((shift + 1) << sub_bits) + static_cast<size_t>(value >> shift) - sub_count;
+    }
+    /** Get the highest value of a bucket.
+     * @param index Bucket index
+     * @return Highest value that falls in this bucket
+    **/
+    static Value highest(size_t index) noexcept {
+        if (index < sub_count) // Exact buckets
+            return index;
+        auto const shift = (index >> sub_bits) - 1;
+        return ((static_cast<Value>(sub_count + (index & (sub_count - 1))) + 1) << shift) - 1;
+    }
+public:
+    /** Empty histogram constructor.
+    **/
+    Histogram() noexcept: buckets{}, total{0} {}
+public:
+    /** Record one value.
+     * @param value Value to record
+    **/
+    void record(Value value) noexcept {
+        ++buckets[index(value)];
+        ++total;
+    }
+    /** Merge the values recorded in another histogram.
+     * @param other Histogram to merge
+     * @return This histogram
+    **/
+    Histogram& operator+=(Histogram const& other) noexcept {
+        for (size_t i = 0; i < nbbuckets; ++i)
+            buckets[i] += other.buckets[i];
+        total += other.total;
+        return *this;
+    }
+    /** Get the total number of recorded values.
+     * @return Number of recorded values
+    **/
+    auto count() const noexcept {
+        return total;
+    }
+    /** Get a percentile of the recorded values.
+     * @param ratio Percentile as a ratio (e.g. 0.99 for p99)
+     * @return Highest value equivalent to the percentile (within the relative error), 0 if no value recorded
+    **/
+    Value percentile(double ratio) const noexcept {
+        auto rank = static_cast<Count>(::std::ceil(ratio * static_cast<double>(total)));
+        if (rank == 0)
+            rank = 1;
+        Count cumul = 0;
+        for (size_t i = 0; i < nbbuckets; ++i) {
+            cumul += buckets[i];
+            if (cumul >= rank)
+                return highest(i);
+        }
+        return 0;
+    }
+};
+
 /** Atomic waitable latch class.
 **/
 class Latch final {
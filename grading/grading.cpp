@@ -23,11 +23,21 @@
 
 // External headers
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cstring>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <random>
+#include <sstream>
 #include <variant>
+#include <vector>
+extern "C" {
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+}
 
 // Internal headers
 #include "common.hpp"
@@ -138,6 +148,221 @@ public:
     }
 };
 
+/** Throughput sampling thread class, sampling while the instance is alive.
+**/
+class Sampler final {
+public:
+    /** Timeline sample class.
+    **/
+    struct Sample {
+        Chrono::Tick  time;    // Time since the sampler started (in ns)
+        uint_fast64_t commits; // Number of commits since the previous sample
+    };
+private:
+    ::std::atomic<bool> running; // Whether the sampling thread must continue
+    ::std::thread       thread;  // Sampling thread, if any
+public:
+    /** Deleted copy constructor/assignment.
+    **/
+    Sampler(Sampler const&) = delete;
+    Sampler& operator=(Sampler const&) = delete;
+    /** Start sampling constructor.
+     * @param stats    Statistics whose recorded commits are sampled
+     * @param period   Sampling period (in ns), 0 for no sampling
+     * @param timeline Timeline to append the samples to (accessed by the sampling thread until destruction)
+    **/
+    Sampler(Statistics const& stats, Chrono::Tick period, ::std::vector<Sample>& timeline): running{true} {
+        if (period == 0)
+            return;
+        thread = ::std::thread{[this, &stats, period, &timeline]() {
+            Chrono clock;
+            clock.start();
+            auto last = stats.get_commits();
+            auto next = ::std::chrono::steady_clock::now();
+            while (running.load(::std::memory_order_relaxed)) {
+                next += ::std::chrono::nanoseconds{period};
+                ::std::this_thread::sleep_until(next);
+                auto time    = clock.delta();
+                auto commits = stats.get_commits();
+                timeline.push_back(Sample{time, commits - last});
+                last = commits;
+            }
+        }};
+    }
+    /** Stop sampling destructor.
+    **/
+    ~Sampler() {
+        running.store(false, ::std::memory_order_relaxed);
+        if (thread.joinable())
+            thread.join();
+    }
+};
+
+/** Hardware performance counters of the calling thread class (Linux 'perf_event_open').
+**/
+class PerfCounters final {
+public:
+    /** Counted events.
+    **/
+    enum Event: size_t {
+        cycles,
+        instructions,
+        branch_misses,
+        llc_misses,
+        transfers, // Raw event given by the user, there is no generic event for cache-line transfers
+        nbevents
+    };
+    constexpr static char const* names[nbevents] = {"cycles", "instructions", "branch misses", "LLC misses", "cache-line transfers"};
+    /** Counter values class.
+    **/
+    using Values = ::std::array<uint_fast64_t, nbevents>;
+private:
+    int fds[nbevents]; // File descriptor of each counter, -1 if unavailable
+public:
+    /** Deleted copy constructor/assignment.
+    **/
+    PerfCounters(PerfCounters const&) = delete;
+    PerfCounters& operator=(PerfCounters const&) = delete;
+    /** Open the counters of the calling thread, counting in user space only.
+     * @param raw Raw event code (see the processor's manual) counted as cache-line transfers, 0 for none
+    **/
+    PerfCounters(uint64_t raw) noexcept {
+        for (size_t event = 0; event < nbevents; ++event) {
+            struct ::perf_event_attr attr;
+            ::std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            switch (event) {
+            case cycles:
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case instructions:
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case branch_misses:
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+            case llc_misses:
+                attr.config = PERF_COUNT_HW_CACHE_MISSES;
+                break;
+            case transfers:
+                attr.type   = PERF_TYPE_RAW;
+                attr.config = raw;
+                break;
+            }
+            attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING; // To scale multiplexed counters
+            attr.exclude_kernel = 1;
+            attr.exclude_hv     = 1;
+            fds[event] = (event == transfers && raw == 0) ? -1 : static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+        }
+    }
+    /** Close the counters destructor.
+    **/
+    ~PerfCounters() noexcept {
+        for (auto&& fd: fds) {
+            if (fd >= 0)
+                ::close(fd);
+        }
+    }
+public:
+    /** Check whether an event is counted.
+     * @param event Event to check
+     * @return Whether the counter could be opened
+    **/
+    bool available(size_t event) const noexcept {
+        return fds[event] >= 0;
+    }
+    /** Read the counters, scaled to the whole time they were enabled.
+     * @return Counter values (0 for the unavailable ones)
+    **/
+    Values read() const noexcept {
+        Values res;
+        for (size_t event = 0; event < nbevents; ++event) {
+            uint64_t buf[3]; // Value, time enabled, time running
+            if (fds[event] < 0 || ::read(fds[event], buf, sizeof(buf)) != sizeof(buf) || buf[2] == 0) {
+                res[event] = 0;
+                continue;
+            }
+            res[event] = static_cast<uint_fast64_t>(static_cast<double>(buf[0]) * static_cast<double>(buf[1]) / static_cast<double>(buf[2]));
+        }
+        return res;
+    }
+};
+
+/** Hardware performance counters of the workers, per measurement phase class.
+**/
+class PerfReport final {
+public:
+    /** Measurement phases.
+    **/
+    enum Phase: size_t {
+        init,
+        perf,
+        chck,
+        nbphases
+    };
+private:
+    uint64_t raw; // Raw event code counted as cache-line transfers, 0 for none
+    bool available[PerfCounters::nbevents]; // Whether each event could be counted (in the master thread)
+    ::std::vector<::std::array<PerfCounters::Values, nbphases>> workers; // Counters of each worker, per phase
+public:
+    /** Deleted copy constructor/assignment.
+    **/
+    PerfReport(PerfReport const&) = delete;
+    PerfReport& operator=(PerfReport const&) = delete;
+    /** Event and worker count constructor, probing which events can be counted.
+     * @param raw       Raw event code counted as cache-line transfers, 0 for none
+     * @param nbworkers Number of workers
+    **/
+    PerfReport(uint64_t raw, size_t nbworkers): raw{raw}, workers(nbworkers) {
+        PerfCounters probe{raw};
+        for (size_t event = 0; event < PerfCounters::nbevents; ++event)
+            available[event] = probe.available(event);
+        for (auto&& worker: workers) {
+            for (auto&& values: worker)
+                values.fill(0);
+        }
+    }
+public:
+    /** Get the raw event code counted as cache-line transfers.
+     * @return Raw event code, 0 for none
+    **/
+    auto get_raw() const noexcept {
+        return raw;
+    }
+    /** Check whether an event could be counted.
+     * @param event Event to check
+     * @return Whether the event is counted
+    **/
+    bool is_available(size_t event) const noexcept {
+        return available[event];
+    }
+    /** [thread-safe] Add the counts of a phase run by a worker.
+     * @param uid    Worker unique ID
+     * @param phase  Measurement phase
+     * @param before Counters before the phase
+     * @param after  Counters after the phase
+    **/
+    void add(unsigned int uid, Phase phase, PerfCounters::Values const& before, PerfCounters::Values const& after) noexcept {
+        auto&& values = workers[uid][phase];
+        for (size_t event = 0; event < PerfCounters::nbevents; ++event)
+            values[event] += after[event] - before[event];
+    }
+    /** Get the counts of a phase, summed over all the workers.
+     * @param phase Measurement phase
+     * @return Counter values
+    **/
+    PerfCounters::Values get(Phase phase) const noexcept {
+        PerfCounters::Values res;
+        res.fill(0);
+        for (auto&& worker: workers) {
+            for (size_t event = 0; event < PerfCounters::nbevents; ++event)
+                res[event] += worker[phase][event];
+        }
+        return res;
+    }
+};
+
 /** Measure the arithmetic mean of the execution time of the given workload with the given transaction library.
  * @param workload     Workload instance to use
  * @param nbthreads    Number of concurrent threads to use
@@ -146,9 +371,12 @@ public:
  * @param maxtick_init Timeout for (re)initialization ('Chrono::invalid_tick' for none)
  * @param maxtick_perf Timeout for performance measurements ('Chrono::invalid_tick' for none)
  * @param maxtick_chck Timeout for correctness check ('Chrono::invalid_tick' for none)
+ * @param period       Period of the throughput sampling during the performance measurements (in ns), 0 for none
+ * @param timeline     Timeline to append the throughput samples to
+ * @param report       Hardware performance counters to add the counts of each phase to, 'nullptr' for none
  * @return Error constant null-terminated string ('nullptr' for none), execution times (in ns) (undefined if inconsistency detected)
 **/
-static auto measure(Workload& workload, unsigned int const nbthreads, unsigned int const nbrepeats, Seed seed, Chrono::Tick maxtick_init, Chrono::Tick maxtick_perf, Chrono::Tick maxtick_chck) {
+static auto measure(Workload& workload, unsigned int const nbthreads, unsigned int const nbrepeats, Seed seed, Chrono::Tick maxtick_init, Chrono::Tick maxtick_perf, Chrono::Tick maxtick_chck, Chrono::Tick period, ::std::vector<Sampler::Sample>& timeline, PerfReport* report) {
     ::std::vector<::std::thread> threads(nbthreads);
     ::std::mutex  cerrlock;        // To avoid interleaving writes to 'cerr' in case more than one thread throw
     Sync          sync{nbthreads}; // "As-synchronized-as-possible" starts so that threads interfere "as-much-as-possible"
@@ -156,20 +384,32 @@ static auto measure(Workload& workload, unsigned int const nbthreads, unsigned i
         try {
             threads[i] = ::std::thread{[&](unsigned int i) {
                 try {
+                    // Hardware performance counters of this thread, if requested
+                    ::std::unique_ptr<PerfCounters> counters;
+                    if (report)
+                        counters = ::std::make_unique<PerfCounters>(report->get_raw());
+                    auto const counted = [&](PerfReport::Phase phase, auto&& func) {
+                        if (!counters)
+                            return func();
+                        auto before = counters->read();
+                        auto error  = func();
+                        report->add(i, phase, before, counters->read());
+                        return error;
+                    };
                     // Initialization
                     if (!sync.worker_wait())
                         return;
-                    sync.worker_notify(workload.init());
+                    sync.worker_notify(counted(PerfReport::init, [&]() { return workload.init(); }));
                     // Performance measurements
                     for (unsigned int count = 0; count < nbrepeats; ++count) {
                         if (!sync.worker_wait())
                             return;
-                        sync.worker_notify(workload.run(i, seed + nbthreads * count + i));
+                        sync.worker_notify(counted(PerfReport::perf, [&]() { return workload.run(i, seed + nbthreads * count + i); }));
                     }
                     // Correctness check
                     if (!sync.worker_wait())
                         return;
-                    sync.worker_notify(workload.check(i, std::random_device{}())); // Random seed is wanted here
+                    sync.worker_notify(counted(PerfReport::chck, [&]() { return workload.check(i, std::random_device{}()); })); // Random seed is wanted here
                     // Synchronized quit
                     if (!sync.worker_wait())
                         return;
@@ -205,6 +445,7 @@ static auto measure(Workload& workload, unsigned int const nbthreads, unsigned i
             time_init = ::std::get<Chrono>(res).get_tick();
         }
         { // Performance measurements (with cheap correctness tests)
+            Sampler sampler{workload.get_statistics(), period, timeline};
             for (unsigned int i = 0; i < nbrepeats; ++i) {
                 sync.master_notify();
                 auto res = sync.master_wait(maxtick_perf);
@@ -238,6 +479,86 @@ static auto measure(Workload& workload, unsigned int const nbthreads, unsigned i
     }
 }
 
+/** Print the tail latency of each transaction kind and the retries per commit.
+ * @param stats Statistics to print
+**/
+static void print_statistics(Statistics const& stats) {
+    constexpr double ratios[] = {0.5, 0.99, 0.999};
+    auto const print = [&](Histogram const& histogram, char const* unit) {
+        auto sep = "";
+        for (auto&& ratio: ratios) {
+            ::std::cout << sep << histogram.percentile(ratio);
+            sep = " / ";
+        }
+        ::std::cout << unit << " (" << histogram.count() << " commits)" << ::std::endl;
+    };
+    ::std::cout << "⎪ Commit latency p50 / p99 / p99.9:" << ::std::endl;
+    for (Statistics::Kind kind = 0; kind < stats.get_nbkinds(); ++kind) {
+        ::std::cout << "⎪   " << stats.get_name(kind) << ": ";
+        print(stats.get_latencies(kind), " ns");
+    }
+    ::std::cout << "⎪ Retries per commit p50 / p99 / p99.9: ";
+    print(stats.get_retries(), "");
+}
+
+/** Print a throughput timeline.
+ * @param timeline Timeline to print
+**/
+static void print_timeline(::std::vector<Sampler::Sample> const& timeline) {
+    ::std::cout << "⎪ Throughput timeline (ms: tx/s):" << ::std::endl;
+    Chrono::Tick prev = 0;
+    for (auto&& sample: timeline) {
+        auto interval = static_cast<double>(sample.time - prev);
+        ::std::cout << "⎪   " << (static_cast<double>(sample.time) / 1000000.) << ": " << (interval > 0. ? static_cast<double>(sample.commits) / interval * 1000000000. : 0.) << ::std::endl;
+        prev = sample.time;
+    }
+}
+
+/** Print the hardware performance counters of each phase, those of the performance measurements per committed transaction.
+ * @param report  Hardware performance counters
+ * @param commits Number of transactions committed during the performance measurements
+**/
+static void print_perf(PerfReport const& report, uint_fast64_t commits) {
+    auto any = false;
+    for (size_t event = 0; event < PerfCounters::nbevents; ++event)
+        any = any || report.is_available(event);
+    if (!any) {
+        ::std::cout << "⎪ Hardware counters: unavailable" << ::std::endl;
+        return;
+    }
+    auto const print = [&](char const* title, PerfReport::Phase phase, double divisor) {
+        auto values = report.get(phase);
+        ::std::cout << "⎪ Hardware counters " << title << ": ";
+        auto sep = "";
+        for (size_t event = 0; event < PerfCounters::nbevents; ++event) {
+            ::std::cout << sep;
+            sep = ", ";
+            if (!report.is_available(event)) {
+                ::std::cout << "n/a " << PerfCounters::names[event];
+                continue;
+            }
+            ::std::cout << (static_cast<double>(values[event]) / divisor) << " " << PerfCounters::names[event];
+        }
+        if (report.is_available(PerfCounters::cycles) && report.is_available(PerfCounters::instructions) && values[PerfCounters::cycles] > 0)
+            ::std::cout << " (" << (static_cast<double>(values[PerfCounters::instructions]) / static_cast<double>(values[PerfCounters::cycles])) << " IPC)";
+        ::std::cout << ::std::endl;
+    };
+    print("per TX", PerfReport::perf, static_cast<double>(commits > 0 ? commits : 1));
+    print("in initialization", PerfReport::init, 1.);
+    print("in check", PerfReport::chck, 1.);
+}
+
+/** Print the counters reported by the library, if it exports them.
+ * @param stats Statistics to print
+**/
+static void print_engine(Statistics const& stats) {
+    TransactionalMemory::Stats engine;
+    if (!stats.get_engine(engine))
+        return;
+    auto const perlogged = static_cast<double>(engine.bytes_logged) / static_cast<double>(engine.commits > 0 ? engine.commits : 1);
+    ::std::cout << "⎪ Library counters: " << engine.commits << " commits, " << engine.aborts_validate << " validation / " << engine.aborts_locked << " locked / " << engine.aborts_alloc << " allocation aborts, " << engine.bytes_logged << " bytes logged (" << perlogged << " per commit)" << ::std::endl;
+}
+
 // -------------------------------------------------------------------------- //
 
 /** Program entry point.
@@ -248,12 +569,93 @@ static auto measure(Workload& workload, unsigned int const nbthreads, unsigned i
 int main(int argc, char** argv) {
     try {
         // Parse command line option(s)
-        if (argc < 3) {
-            ::std::cout << "Usage: " << (argc > 0 ? argv[0] : "grading") << " <seed> <reference library path> <tested library path>..." << ::std::endl;
+        auto sweep = size_t{0};         // Maximum number of threads of the scaling sweep, 0 for no sweep, 'SIZE_MAX' for #worker threads
+        char const* csvpath = nullptr;  // Path of the CSV output of the sweep, 'nullptr' for the standard output
+        auto period = Chrono::Tick{0};  // Period of the throughput timeline (in ns), 0 for no timeline
+        auto perf   = false;            // Whether to count hardware performance events
+        auto raw    = uint64_t{0};      // Raw event code counted as cache-line transfers, 0 for none
+        auto hashmap     = false;       // Whether to run the hash map workload instead of the bank
+        auto nbbuckets   = size_t{0};   // Number of buckets of the hash map, 0 for the default
+        auto load_factor = 2.f;         // Expected average number of entries per bucket of the hash map
+        float mix[3]     = {8.f, 1.f, 1.f}; // Relative weights of the lookups, insertions and removals of the hash map
+        auto argi = 1;
+        for (; argi < argc && ::std::strncmp(argv[argi], "--", 2) == 0; ++argi) {
+            auto const arg = argv[argi];
+            if (::std::strcmp(arg, "--sweep") == 0) {
+                sweep = SIZE_MAX;
+            } else if (::std::strncmp(arg, "--sweep=", 8) == 0) {
+                sweep = ::std::stoul(arg + 8);
+                if (unlikely(sweep == 0)) {
+                    ::std::cout << "Invalid maximum #threads in '" << arg << "'" << ::std::endl;
+                    return 1;
+                }
+            } else if (::std::strncmp(arg, "--csv=", 6) == 0) {
+                csvpath = arg + 6;
+            } else if (::std::strcmp(arg, "--perf") == 0) {
+                perf = true;
+            } else if (::std::strncmp(arg, "--perf=", 7) == 0) {
+                perf = true;
+                raw  = ::std::stoull(arg + 7, nullptr, 0);
+            } else if (::std::strcmp(arg, "--hashmap") == 0) {
+                hashmap = true;
+            } else if (::std::strncmp(arg, "--buckets=", 10) == 0) {
+                nbbuckets = ::std::stoul(arg + 10);
+                if (unlikely(nbbuckets == 0)) {
+                    ::std::cout << "Invalid #buckets in '" << arg << "'" << ::std::endl;
+                    return 1;
+                }
+            } else if (::std::strncmp(arg, "--load-factor=", 14) == 0) {
+                load_factor = ::std::stof(arg + 14);
+                if (unlikely(!(load_factor > 0.f))) {
+                    ::std::cout << "Invalid load factor in '" << arg << "'" << ::std::endl;
+                    return 1;
+                }
+            } else if (::std::strncmp(arg, "--mix=", 6) == 0) {
+                char const* pos = arg + 6;
+                for (auto&& weight: mix) {
+                    char* end;
+                    weight = ::std::strtof(pos, &end);
+                    if (unlikely(end == pos || weight < 0.f || *end != (&weight == mix + 2 ? '\0' : ','))) {
+                        ::std::cout << "Invalid mix in '" << arg << "', expected <get>,<put>,<remove>" << ::std::endl;
+                        return 1;
+                    }
+                    pos = end + 1;
+                }
+                if (unlikely(!(mix[0] + mix[1] + mix[2] > 0.f))) {
+                    ::std::cout << "Invalid mix in '" << arg << "', expected at least one positive weight" << ::std::endl;
+                    return 1;
+                }
+            } else if (::std::strncmp(arg, "--timeline=", 11) == 0) {
+                period = static_cast<Chrono::Tick>(::std::stoul(arg + 11)) * 1000000;
+                if (unlikely(period == 0)) {
+                    ::std::cout << "Invalid period in '" << arg << "'" << ::std::endl;
+                    return 1;
+                }
+            } else {
+                ::std::cout << "Unknown option '" << arg << "'" << ::std::endl;
+                return 1;
+            }
+        }
+        auto const options = "[--sweep[=<max #threads>]] [--csv=<path>] [--timeline=<period in ms>] [--perf[=<raw transfer event>]] [--hashmap [--buckets=<#buckets>] [--load-factor=<entries per bucket>] [--mix=<get>,<put>,<remove>]] ";
+#if defined(TM_LINKED)
+        if (argc - argi < 1) {
+            ::std::cout << "Usage: " << (argc > 0 ? argv[0] : "grading") << " " << options << "<seed>" << ::std::endl;
+            return 1;
+        }
+        char const* const libraries[] = {TM_LINKED}; // Only the linked engine, which is its own reference
+        auto const nblibraries = 1;
+#else
+        if (argc - argi < 2) {
+            ::std::cout << "Usage: " << (argc > 0 ? argv[0] : "grading") << " " << options << "<seed> <reference library path> <tested library path>..." << ::std::endl;
             return 1;
         }
+        auto const libraries   = argv + argi + 1;
+        auto const nblibraries = argc - argi - 1;
+#endif
         // Get/set/compute run parameters
-        auto const nbworkers = []() {
+        auto const nbworkers = [&]() {
+            if (sweep != 0 && sweep != SIZE_MAX)
+                return sweep;
             auto res = ::std::thread::hardware_concurrency();
             if (unlikely(res == 0))
                 res = 16;
@@ -265,19 +667,43 @@ int main(int argc, char** argv) {
         auto const init_balance  = 100ul;
         auto const prob_long     = 0.5f;
         auto const prob_alloc    = 0.01f;
+        auto const hm_nbbuckets  = nbbuckets > 0 ? nbbuckets : 256 * nbworkers;
+        auto const hm_prob_get   = mix[0] / (mix[0] + mix[1] + mix[2]);
+        auto const hm_prob_put   = mix[1] / (mix[0] + mix[1] + mix[2]);
         auto const nbrepeats     = 7;
-        auto const seed          = static_cast<Seed>(::std::stoul(argv[1]));
+        auto const seed          = static_cast<Seed>(::std::stoul(argv[argi]));
         auto const clk_res       = Chrono::get_resolution();
         auto const slow_factor   = 8ul;
+        // Compute the thread counts to evaluate: 1, 2, 4... then #worker threads, or only #worker threads without sweep
+        ::std::vector<size_t> nbthreadss;
+        if (sweep != 0) {
+            for (size_t nbthreads = 1; nbthreads < nbworkers; nbthreads *= 2)
+                nbthreadss.push_back(nbthreads);
+        }
+        nbthreadss.push_back(nbworkers);
         // Print run parameters
-        ::std::cout << "⎧ #worker threads:     " << nbworkers << ::std::endl;
+        ::std::cout << "⎧ #worker threads:     ";
+        if (sweep != 0) {
+            for (auto&& nbthreads: nbthreadss)
+                ::std::cout << nbthreads << (nbthreads == nbworkers ? " (sweep)" : ", ");
+            ::std::cout << ::std::endl;
+        } else {
+            ::std::cout << nbworkers << ::std::endl;
+        }
         ::std::cout << "⎪ #TX per worker:      " << nbtxperwrk << ::std::endl;
         ::std::cout << "⎪ #repetitions:        " << nbrepeats << ::std::endl;
-        ::std::cout << "⎪ Initial #accounts:   " << nbaccounts << ::std::endl;
-        ::std::cout << "⎪ Expected #accounts:  " << expnbaccounts << ::std::endl;
-        ::std::cout << "⎪ Initial balance:     " << init_balance << ::std::endl;
-        ::std::cout << "⎪ Long TX probability: " << prob_long << ::std::endl;
-        ::std::cout << "⎪ Allocation TX prob.: " << prob_alloc << ::std::endl;
+        if (hashmap) {
+            ::std::cout << "⎪ Workload:            hash map" << ::std::endl;
+            ::std::cout << "⎪ #buckets:            " << hm_nbbuckets << ::std::endl;
+            ::std::cout << "⎪ Load factor:         " << load_factor << ::std::endl;
+            ::std::cout << "⎪ Get/put/remove prob: " << hm_prob_get << " / " << hm_prob_put << " / " << (1.f - hm_prob_get - hm_prob_put) << ::std::endl;
+        } else {
+            ::std::cout << "⎪ Initial #accounts:   " << nbaccounts << ::std::endl;
+            ::std::cout << "⎪ Expected #accounts:  " << expnbaccounts << ::std::endl;
+            ::std::cout << "⎪ Initial balance:     " << init_balance << ::std::endl;
+            ::std::cout << "⎪ Long TX probability: " << prob_long << ::std::endl;
+            ::std::cout << "⎪ Allocation TX prob.: " << prob_alloc << ::std::endl;
+        }
         ::std::cout << "⎪ Slow trigger factor: " << slow_factor << ::std::endl;
         ::std::cout << "⎪ Clock resolution:    ";
         if (unlikely(clk_res == Chrono::invalid_tick)) {
@@ -286,53 +712,97 @@ int main(int argc, char** argv) {
             ::std::cout << clk_res << " ns" << ::std::endl;
         }
         ::std::cout << "⎩ Seed value:          " << seed << ::std::endl;
-        // Library evaluations
-        double reference = 0.; // Set to avoid irrelevant '-Wmaybe-uninitialized'
-        auto const pertxdiv = static_cast<double>(nbworkers) * static_cast<double>(nbtxperwrk);
-        auto maxtick_init = Chrono::invalid_tick;
-        auto maxtick_perf = Chrono::invalid_tick;
-        auto maxtick_chck = Chrono::invalid_tick;
-        for (auto i = 2; i < argc; ++i) {
-            ::std::cout << "⎧ Evaluating '" << argv[i] << "'" << (maxtick_init == Chrono::invalid_tick ? " (reference)" : "") << "..." << ::std::endl;
-            // Load TM library
-            TransactionalLibrary tl{argv[i]};
-            // Initialize workload (shared memory lifetime bound to workload: created and destroyed at the same time)
-            WorkloadBank bank{tl, nbworkers, nbtxperwrk, nbaccounts, expnbaccounts, init_balance, prob_long, prob_alloc};
-            try {
-                // Actual performance measurements and correctness check
-                auto res = measure(bank, nbworkers, nbrepeats, seed, maxtick_init, maxtick_perf, maxtick_chck);
-                // Check false negative-free correctness
-                auto error = ::std::get<0>(res);
-                if (unlikely(error)) {
-                    ::std::cout << "⎩ " << error << ::std::endl;
-                    return 1;
+        // Library evaluations, for each thread count (the reference is evaluated first at each point)
+        ::std::ostringstream csv; // Sweep results, one line per (library, thread count)
+        csv << "library,threads,time_ms,tx_per_s,speedup,efficiency" << ::std::endl;
+        ::std::vector<double> baselines(nblibraries, 0.); // Throughput with one thread, per library
+        for (auto&& nbthreads: nbthreadss) {
+            double reference = 0.; // Set to avoid irrelevant '-Wmaybe-uninitialized'
+            auto const nbtxs = static_cast<double>(nbthreads) * static_cast<double>(nbtxperwrk);
+            auto maxtick_init = Chrono::invalid_tick;
+            auto maxtick_perf = Chrono::invalid_tick;
+            auto maxtick_chck = Chrono::invalid_tick;
+            for (auto i = 0; i < nblibraries; ++i) {
+                ::std::cout << "⎧ Evaluating '" << libraries[i] << "'" << (maxtick_init == Chrono::invalid_tick ? " (reference)" : "");
+                if (sweep != 0)
+                    ::std::cout << " with " << nbthreads << " thread(s)";
+                ::std::cout << "..." << ::std::endl;
+                // Load TM library
+                TransactionalLibrary tl{libraries[i]};
+                // Initialize workload (shared memory lifetime bound to workload: created and destroyed at the same time)
+                ::std::unique_ptr<Workload> workload;
+                if (hashmap) {
+                    workload = ::std::make_unique<WorkloadHashMap>(tl, nbthreads, nbtxperwrk, hm_nbbuckets, load_factor, hm_prob_get, hm_prob_put);
+                } else {
+                    workload = ::std::make_unique<WorkloadBank>(tl, nbthreads, nbtxperwrk, nbaccounts, expnbaccounts, init_balance, prob_long, prob_alloc);
+                }
+                try {
+                    // Actual performance measurements and correctness check
+                    ::std::vector<Sampler::Sample> timeline;
+                    ::std::unique_ptr<PerfReport> report;
+                    if (perf)
+                        report = ::std::make_unique<PerfReport>(raw, nbthreads);
+                    auto res = measure(*workload, nbthreads, nbrepeats, seed, maxtick_init, maxtick_perf, maxtick_chck, period, timeline, report.get());
+                    // Check false negative-free correctness
+                    auto error = ::std::get<0>(res);
+                    if (unlikely(error)) {
+                        ::std::cout << "⎩ " << error << ::std::endl;
+                        return 1;
+                    }
+                    // Print results
+                    auto tick_init = ::std::get<1>(res);
+                    auto tick_perf = ::std::get<2>(res);
+                    auto tick_chck = ::std::get<3>(res);
+                    auto perfdbl = static_cast<double>(tick_perf);
+                    ::std::cout << "⎪ Total user execution time: " << (perfdbl / 1000000.) << " ms";
+                    if (maxtick_init == Chrono::invalid_tick) { // Set reference performance
+                        maxtick_init = slow_factor * tick_init;
+                        if (unlikely(maxtick_init == Chrono::invalid_tick)) // Bad luck...
+                            ++maxtick_init;
+                        maxtick_perf = slow_factor * tick_perf;
+                        if (unlikely(maxtick_perf == Chrono::invalid_tick)) // Bad luck...
+                            ++maxtick_perf;
+                        maxtick_chck = slow_factor * tick_chck;
+                        if (unlikely(maxtick_chck == Chrono::invalid_tick)) // Bad luck...
+                            ++maxtick_chck;
+                        reference = perfdbl;
+                    } else { // Compare with reference performance
+                        ::std::cout << " -> " << (reference / perfdbl) << " speedup";
+                    }
+                    ::std::cout << ::std::endl;
+                    print_engine(workload->get_statistics());
+                    if (sweep != 0) { // Throughput and parallel efficiency against the single thread throughput of the same library
+                        auto const throughput = nbtxs / perfdbl * 1000000000.;
+                        if (nbthreads == 1)
+                            baselines[i] = throughput;
+                        auto const efficiency = throughput / (static_cast<double>(nbthreads) * baselines[i]);
+                        ::std::cout << "⎪ Throughput: " << throughput << " tx/s -> " << efficiency << " parallel efficiency" << ::std::endl;
+                        csv << libraries[i] << "," << nbthreads << "," << (perfdbl / 1000000.) << "," << throughput << "," << (reference / perfdbl) << "," << efficiency << ::std::endl;
+                    }
+                    print_statistics(workload->get_statistics());
+                    if (period != 0)
+                        print_timeline(timeline);
+                    if (report)
+                        print_perf(*report, workload->get_statistics().get_commits());
+                    ::std::cout << "⎩ Average TX execution time: " << (perfdbl / nbtxs) << " ns" << ::std::endl;
+                } catch (::std::exception const& err) { // Special case: cannot unload library with running threads, so print error and quick-exit
+                    ::std::cerr << "⎪ *** EXCEPTION ***" << ::std::endl;
+                    ::std::cerr << "⎩ " << err.what() << ::std::endl;
+                    ::std::quick_exit(2);
                 }
-                // Print results
-                auto tick_init = ::std::get<1>(res);
-                auto tick_perf = ::std::get<2>(res);
-                auto tick_chck = ::std::get<3>(res);
-                auto perfdbl = static_cast<double>(tick_perf);
-                ::std::cout << "⎪ Total user execution time: " << (perfdbl / 1000000.) << " ms";
-                if (maxtick_init == Chrono::invalid_tick) { // Set reference performance
-                    maxtick_init = slow_factor * tick_init;
-                    if (unlikely(maxtick_init == Chrono::invalid_tick)) // Bad luck...
-                        ++maxtick_init;
-                    maxtick_perf = slow_factor * tick_perf;
-                    if (unlikely(maxtick_perf == Chrono::invalid_tick)) // Bad luck...
-                        ++maxtick_perf;
-                    maxtick_chck = slow_factor * tick_chck;
-                    if (unlikely(maxtick_chck == Chrono::invalid_tick)) // Bad luck...
-                        ++maxtick_chck;
-                    reference = perfdbl;
-                } else { // Compare with reference performance
-                    ::std::cout << " -> " << (reference / perfdbl) << " speedup";
+            }
+        }
+        // Sweep results output
+        if (sweep != 0) {
+            if (csvpath) {
+                ::std::ofstream file{csvpath};
+                file << csv.str();
+                if (unlikely(!file)) {
+                    ::std::cout << "Unable to write the sweep results to '" << csvpath << "'" << ::std::endl;
+                    return 1;
                 }
-                ::std::cout << ::std::endl;
-                ::std::cout << "⎩ Average TX execution time: " << (perfdbl / pertxdiv) << " ns" << ::std::endl;
-            } catch (::std::exception const& err) { // Special case: cannot unload library with running threads, so print error and quick-exit
-                ::std::cerr << "⎪ *** EXCEPTION ***" << ::std::endl;
-                ::std::cerr << "⎩ " << err.what() << ::std::endl;
-                ::std::quick_exit(2);
+            } else {
+                ::std::cout << csv.str();
             }
         }
         return 0;
@@ -27,12 +27,23 @@
 extern "C" {
 #include <dlfcn.h>
 #include <limits.h>
+#include <stdint.h>
 }
 
 // Internal headers
 namespace STM {
 #include <tm.hpp>
+#include <tm_stats.h>
+#if defined(TM_LINKED) && !defined(TM_INLINE)
+    extern "C" void tm_stats(shared_t, struct tm_stats*) __attribute__((weak)); // Optional, null if the linked engine does not define it
+#endif
 }
+#if defined(TM_INLINE)
+    #include <tm_inline.hpp>
+    #if !defined(TM_LINKED)
+        #define TM_LINKED "inline" // The header-only engine is the linked engine
+    #endif
+#endif
 #include "common.hpp"
 
 // -------------------------------------------------------------------------- //
@@ -63,6 +74,9 @@ EXCEPTION(Shared, Any, "operation in shared memory exception");
 // -------------------------------------------------------------------------- //
 
 /** Transactional library management class.
+ * With 'TM_LINKED' defined (to the name of the engine), the 'tm_*' symbols are those of the engine linked in the program, called directly
+ * (and possibly inlined at link time) instead of through 'dlsym'-resolved pointers; the library path is then ignored.
+ * With 'TM_INLINE' defined, the 'tm_*' functions are those of the header-only engine of 'tm_inline.hpp', inlined at compile time.
 **/
 class TransactionalLibrary final: private NonCopyable {
     friend class TransactionalMemory;
@@ -80,7 +94,51 @@ private:
     using FnWrite   = decltype(&STM::tm_write);
     using FnAlloc   = decltype(&STM::tm_alloc);
     using FnFree    = decltype(&STM::tm_free);
+    using FnStats   = decltype(&STM::tm_stats);
 private:
+#if defined(TM_INLINE)
+    constexpr static FnCreate  tm_create  = &STMInline::create;
+    constexpr static FnDestroy tm_destroy = &STMInline::destroy;
+    constexpr static FnStart   tm_start   = &STMInline::start;
+    constexpr static FnSize    tm_size    = &STMInline::size;
+    constexpr static FnAlign   tm_align   = &STMInline::align;
+    constexpr static FnBegin   tm_begin   = &STMInline::begin;
+    constexpr static FnEnd     tm_end     = &STMInline::end;
+    constexpr static FnRead    tm_read    = &STMInline::read;
+    constexpr static FnWrite   tm_write   = &STMInline::write;
+    constexpr static FnFree    tm_free    = &STMInline::free;
+    constexpr static FnStats   tm_stats   = nullptr;
+    /** Memory allocation in the header-only engine.
+     * @param ... Forwarded arguments
+     * @return Allocation status
+    **/
+    static STM::Alloc tm_alloc(STM::shared_t shared, STM::tx_t tx, size_t size, void** target) noexcept {
+        return static_cast<STM::Alloc>(STMInline::alloc(shared, tx, size, target));
+    }
+public:
+    /** Linked engine constructor.
+     * @param path Ignored
+    **/
+    TransactionalLibrary(char const* path [[gnu::unused]]) {}
+#elif defined(TM_LINKED)
+    constexpr static FnCreate  tm_create  = &STM::tm_create;
+    constexpr static FnDestroy tm_destroy = &STM::tm_destroy;
+    constexpr static FnStart   tm_start   = &STM::tm_start;
+    constexpr static FnSize    tm_size    = &STM::tm_size;
+    constexpr static FnAlign   tm_align   = &STM::tm_align;
+    constexpr static FnBegin   tm_begin   = &STM::tm_begin;
+    constexpr static FnEnd     tm_end     = &STM::tm_end;
+    constexpr static FnRead    tm_read    = &STM::tm_read;
+    constexpr static FnWrite   tm_write   = &STM::tm_write;
+    constexpr static FnAlloc   tm_alloc   = &STM::tm_alloc;
+    constexpr static FnFree    tm_free    = &STM::tm_free;
+    constexpr static FnStats   tm_stats   = &STM::tm_stats;
+public:
+    /** Linked engine constructor.
+     * @param path Ignored
+    **/
+    TransactionalLibrary(char const* path [[gnu::unused]]) {}
+#else
     void*     module;     // Module opaque handler
     FnCreate  tm_create;  // Module's initialization function
     FnDestroy tm_destroy; // Module's cleanup function
@@ -93,6 +151,7 @@ private:
     FnWrite   tm_write;   // Module's shared memory write function
     FnAlloc   tm_alloc;   // Module's shared memory allocation function
     FnFree    tm_free;    // Module's shared memory freeing function
+    FnStats   tm_stats;   // Module's statistics function, 'nullptr' if the module does not export it
 private:
     /** Solve a symbol from its name, and bind it to the given function.
      * @param name Name of the symbol to resolve
@@ -107,6 +166,14 @@ private:
     template<class Signature> void solve(char const* name, Signature& func) const {
         func = solve<Signature>(name);
     }
+    /** Solve an optional symbol from its name, and bind it to the given function.
+     * @param name Name of the symbol to resolve
+     * @param func Target function to bind, 'nullptr' if the symbol is not found
+    **/
+    template<class Signature> void solve_optional(char const* name, Signature& func) const noexcept {
+        auto res = ::dlsym(module, name);
+        func = *reinterpret_cast<Signature*>(&res);
+    }
 public:
     /** Loader constructor.
      * @param path  Path to the library to load
@@ -132,6 +199,7 @@ public:
             solve("tm_write", tm_write);
             solve("tm_alloc", tm_alloc);
             solve("tm_free", tm_free);
+            solve_optional("tm_stats", tm_stats);
         }
     }
     /** Unloader destructor.
@@ -139,6 +207,7 @@ public:
     ~TransactionalLibrary() noexcept {
         ::dlclose(module); // Close loaded module
     }
+#endif
 };
 
 /** One shared memory region management class.
@@ -157,6 +226,9 @@ public:
     /** Transaction class alias.
     **/
     using TX = STM::tx_t;
+    /** Statistics class alias.
+    **/
+    using Stats = struct STM::tm_stats;
 private:
     TransactionalLibrary const& tl; // Bound transactional library
     Shared shared;     // Handle of the shared memory region used
@@ -205,6 +277,16 @@ public:
     auto get_align() const noexcept {
         return alignment;
     }
+    /** [thread-safe] Get the statistics of the calling thread, if the library exports them.
+     * @param stats Statistics to fill
+     * @return Whether the library exports statistics (otherwise 'stats' is left untouched)
+    **/
+    bool get_stats(Stats& stats) const noexcept {
+        if (!tl.tm_stats)
+            return false;
+        tl.tm_stats(shared, &stats);
+        return true;
+    }
 public:
     /** [thread-safe] Begin a new transaction on the shared memory region.
      * @param ro Whether the transaction is read-only
@@ -240,6 +322,32 @@ public:
     auto write(TX tx, void const* source, size_t size, void* target) const noexcept {
         return tl.tm_write(shared, tx, source, size, target);
     }
+    /** [thread-safe] Read operation of one value in the given transaction, source in the shared region and target in a private region.
+     * @param tx     Transaction to use
+     * @param source Source value
+     * @param target Target value
+     * @return Whether the whole transaction can continue
+    **/
+    template<class Type> auto read(TX tx, Type const* source, Type& target) const noexcept {
+#if defined(TM_INLINE)
+        return STMInline::read(shared, tx, source, target);
+#else
+        return read(tx, source, sizeof(Type), &target);
+#endif
+    }
+    /** [thread-safe] Write operation of one value in the given transaction, source in a private region and target in the shared region.
+     * @param tx     Transaction to use
+     * @param source Source value
+     * @param target Target value
+     * @return Whether the whole transaction can continue
+    **/
+    template<class Type> auto write(TX tx, Type const& source, Type* target) const noexcept {
+#if defined(TM_INLINE)
+        return STMInline::write(shared, tx, source, target);
+#else
+        return write(tx, &source, sizeof(Type), target);
+#endif
+    }
     /** [thread-safe] Memory allocation operation in the given transaction, throw if no memory available.
      * @param tx     Transaction to use
      * @param size   Size to allocate
@@ -327,6 +435,30 @@ public:
             throw Exception::TransactionRetry{};
         }
     }
+    /** [thread-safe] Read operation of one value in the bound transaction, source in the shared region and target in a private region.
+     * @param source Source value
+     * @return Private copy of the source value
+    **/
+    template<class Type> Type read(Type const* source) {
+        Type res;
+        if (unlikely(!tm.read(tx, source, res))) {
+            aborted = true;
+            throw Exception::TransactionRetry{};
+        }
+        return res;
+    }
+    /** [thread-safe] Write operation of one value in the bound transaction, source in a private region and target in the shared region.
+     * @param source Source value
+     * @param target Target value
+    **/
+    template<class Type> void write(Type const& source, Type* target) {
+        if (unlikely(assert_mode && is_ro))
+            throw Exception::TransactionReadOnly{};
+        if (unlikely(!tm.write(tx, source, target))) {
+            aborted = true;
+            throw Exception::TransactionRetry{};
+        }
+    }
     /** [thread-safe] Memory allocation operation in the bound transaction, throw if no memory available.
      * @param size Size to allocate
      * @return Target start address
@@ -390,9 +522,7 @@ public:
      * @return Private copy of the content at the shared address
     **/
     Type read() const {
-        Type res;
-        tx.read(address, sizeof(Type), &res);
-        return res;
+        return tx.read(static_cast<Type const*>(address));
     }
     operator Type() const {
         return read();
@@ -401,7 +531,7 @@ public:
      * @param source Private content to write at the shared address
     **/
     void write(Type const& source) const {
-        tx.write(&source, sizeof(Type), address);
+        tx.write(source, address);
     }
     void operator=(Type const& source) const {
         return write(source);
@@ -441,9 +571,7 @@ public:
      * @return Private copy of the content at the shared address
     **/
     Type* read() const {
-        Type* res;
-        tx.read(address, sizeof(Type*), &res);
-        return res;
+        return tx.read(static_cast<Type* const*>(address));
     }
     operator Type*() const {
         return read();
@@ -452,7 +580,7 @@ public:
      * @param source Private content to write at the shared address
     **/
     void write(Type* source) const {
-        tx.write(&source, sizeof(Type*), address);
+        tx.write(source, address);
     }
     void operator=(Type* source) const {
         return write(source);
@@ -512,16 +640,30 @@ public:
      * @return Private copy of the content at the shared address
     **/
     Type read(size_t index) const {
-        Type res;
-        tx.read(address + index, sizeof(Type), &res);
-        return res;
+        return tx.read(static_cast<Type const*>(address + index));
     }
     /** Write operation.
      * @param index  Index to write
      * @param source Private content to write at the shared address
     **/
     void write(size_t index, Type const& source) const {
-        tx.write(tx, &source, sizeof(Type), address + index);
+        tx.write(source, address + index);
+    }
+    /** Span read operation, in one call to the transactional library.
+     * @param index  Index of the first cell to read
+     * @param count  Non-null number of cells to read
+     * @param target Private array receiving the copies of the cells
+    **/
+    void read(size_t index, size_t count, Type* target) const {
+        tx.read(address + index, count * sizeof(Type), target);
+    }
+    /** Span write operation, in one call to the transactional library.
+     * @param index  Index of the first cell to write
+     * @param count  Non-null number of cells to write
+     * @param source Private array of the contents to write
+    **/
+    void write(size_t index, size_t count, Type const* source) const {
+        tx.write(source, count * sizeof(Type), address + index);
     }
 public:
     /** Reference a cell.
@@ -569,9 +711,7 @@ public:
     Type read(size_t index) const {
         if (unlikely(assert_mode && index >= n))
             throw Exception::SharedOverflow{};
-        Type res;
-        tx.read(address + index, sizeof(Type), &res);
-        return res;
+        return tx.read(static_cast<Type const*>(address + index));
     }
     /** Write operation.
      * @param index  Index to write
@@ -580,7 +720,7 @@ public:
     void write(size_t index, Type const& source) const {
         if (unlikely(assert_mode && index >= n))
             throw Exception::SharedOverflow{};
-        tx.write(tx, &source, sizeof(Type), address + index);
+        tx.write(source, address + index);
     }
 public:
     /** Reference a cell.
@@ -603,18 +743,25 @@ public:
 // -------------------------------------------------------------------------- //
 
 /** Repeat a given transaction until it commits.
- * @param tm   Transactional memory
- * @param mode Transactional mode
- * @param func Transaction closure (Transaction& -> ...)
+ * @param tm        Transactional memory
+ * @param mode      Transactional mode
+ * @param func      Transaction closure (Transaction& -> ...)
+ * @param nbretries Number of aborted attempts before the commit (output)
  * @return Returned value (or void) when the transaction committed
 **/
-template<class Func> static auto transactional(TransactionalMemory const& tm, Transaction::Mode mode, Func&& func) {
+template<class Func> static auto transactional(TransactionalMemory const& tm, Transaction::Mode mode, Func&& func, size_t& nbretries) {
+    nbretries = 0;
     do {
         try {
             Transaction tx{tm, mode};
             return func(tx);
         } catch (Exception::TransactionRetry const&) {
+            ++nbretries;
             continue;
         }
     } while (true);
 }
+template<class Func> static auto transactional(TransactionalMemory const& tm, Transaction::Mode mode, Func&& func) {
+    size_t nbretries;
+    return transactional(tm, mode, ::std::forward<Func>(func), nbretries);
+}
@@ -24,8 +24,12 @@
 #pragma once
 
 // External headers
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <initializer_list>
 #include <random>
+#include <vector>
 
 // Internal headers
 #include "common.hpp"
@@ -40,27 +44,174 @@ using Uid = uint_fast32_t;
 **/
 using Seed = uint_fast32_t;
 
+/** Per-worker transaction statistics class.
+**/
+class Statistics final {
+public:
+    /** Transaction kind class (index in the kind names).
+    **/
+    using Kind = size_t;
+private:
+    /** Statistics of one worker, only written by that worker.
+    **/
+    struct Worker {
+        ::std::vector<Histogram> latencies; // Commit latency (in ns, retries included), per transaction kind
+        Histogram                  retries; // Number of retries per commit
+        TransactionalMemory::Stats engine;  // Counters reported by the library over the measured scopes
+        TransactionalMemory::Stats since;   // Counters reported by the library at the start of the current scope
+        bool                       exports; // Whether the library reported counters
+        ::std::atomic<uint_fast64_t> commits; // Number of commits recorded, read concurrently by the sampler
+    };
+private:
+    ::std::vector<char const*> names;   // Transaction kind names
+    ::std::vector<Worker>      workers; // Per-worker statistics
+public:
+    /** Deleted copy constructor/assignment.
+    **/
+    Statistics(Statistics const&) = delete;
+    Statistics& operator=(Statistics const&) = delete;
+    /** Kind names and worker count constructor.
+     * @param names     Transaction kind names
+     * @param nbworkers Number of workers
+    **/
+    Statistics(::std::initializer_list<char const*> names, size_t nbworkers): names{names}, workers(nbworkers) {
+        for (auto&& worker: workers) {
+            worker.latencies.resize(this->names.size());
+            worker.engine  = {};
+            worker.exports = false;
+            worker.commits.store(0, ::std::memory_order_relaxed);
+        }
+    }
+public:
+    /** [thread-safe] Record one commit of a worker.
+     * @param uid       Worker unique ID
+     * @param kind      Transaction kind
+     * @param latency   Commit latency (in ns)
+     * @param nbretries Number of retries before the commit
+    **/
+    void record(Uid uid, Kind kind, Chrono::Tick latency, size_t nbretries) noexcept {
+        auto&& worker = workers[uid];
+        worker.latencies[kind].record(latency);
+        worker.retries.record(nbretries);
+        worker.commits.store(worker.commits.load(::std::memory_order_relaxed) + 1, ::std::memory_order_relaxed); // Only writer
+    }
+    /** [thread-safe] Get the number of commits recorded so far, summed over all the workers.
+     * @return Number of commits
+    **/
+    uint_fast64_t get_commits() const noexcept {
+        uint_fast64_t res = 0;
+        for (auto&& worker: workers)
+            res += worker.commits.load(::std::memory_order_relaxed);
+        return res;
+    }
+    /** [thread-safe] Start a scope whose library counters are accumulated, from the worker's thread.
+     * @param uid Worker unique ID
+     * @param tm  Transactional memory the worker uses
+    **/
+    void engine_start(Uid uid, TransactionalMemory const& tm) noexcept {
+        auto&& worker = workers[uid];
+        worker.exports = tm.get_stats(worker.since);
+    }
+    /** [thread-safe] End a scope started with 'engine_start', from the same thread.
+     * @param uid Worker unique ID
+     * @param tm  Transactional memory the worker uses
+    **/
+    void engine_stop(Uid uid, TransactionalMemory const& tm) noexcept {
+        auto&& worker = workers[uid];
+        TransactionalMemory::Stats now;
+        if (!worker.exports || !tm.get_stats(now))
+            return;
+        worker.engine.commits         += now.commits - worker.since.commits;
+        worker.engine.aborts_validate += now.aborts_validate - worker.since.aborts_validate;
+        worker.engine.aborts_locked   += now.aborts_locked - worker.since.aborts_locked;
+        worker.engine.aborts_alloc    += now.aborts_alloc - worker.since.aborts_alloc;
+        worker.engine.bytes_logged    += now.bytes_logged - worker.since.bytes_logged;
+    }
+    /** Get the number of transaction kinds.
+     * @return Number of kinds
+    **/
+    auto get_nbkinds() const noexcept {
+        return names.size();
+    }
+    /** Get the name of a transaction kind.
+     * @param kind Transaction kind
+     * @return Null-terminated name
+    **/
+    auto get_name(Kind kind) const noexcept {
+        return names[kind];
+    }
+    /** Get the commit latencies of a transaction kind, merged over all the workers.
+     * @param kind Transaction kind
+     * @return Merged histogram
+    **/
+    auto get_latencies(Kind kind) const {
+        Histogram res;
+        for (auto&& worker: workers)
+            res += worker.latencies[kind];
+        return res;
+    }
+    /** Get the library counters, summed over all the workers.
+     * @param res Counters to fill
+     * @return Whether the library reported counters (otherwise 'res' is left untouched)
+    **/
+    bool get_engine(TransactionalMemory::Stats& res) const noexcept {
+        TransactionalMemory::Stats sum = {};
+        auto exports = false;
+        for (auto&& worker: workers) {
+            if (!worker.exports)
+                continue;
+            exports = true;
+            sum.commits         += worker.engine.commits;
+            sum.aborts_validate += worker.engine.aborts_validate;
+            sum.aborts_locked   += worker.engine.aborts_locked;
+            sum.aborts_alloc    += worker.engine.aborts_alloc;
+            sum.bytes_logged    += worker.engine.bytes_logged;
+        }
+        if (exports)
+            res = sum;
+        return exports;
+    }
+    /** Get the retries per commit, merged over all the workers.
+     * @return Merged histogram
+    **/
+    auto get_retries() const {
+        Histogram res;
+        for (auto&& worker: workers)
+            res += worker.retries;
+        return res;
+    }
+};
+
 /** Workload base class.
 **/
 class Workload {
 protected:
     TransactionalLibrary const& tl;  // Associated transactional library
     TransactionalMemory         tm;  // Built transactional memory to use
+    Statistics mutable       stats;  // Statistics of the transactions run by 'run'
 public:
     /** Deleted copy constructor/assignment.
     **/
     Workload(Workload const&) = delete;
     Workload& operator=(Workload const&) = delete;
     /** Transactional memory constructor.
-     * @param library Transactional library to use
-     * @param align   Shared memory region required alignment
-     * @param size    Size of the shared memory region to allocate
+     * @param library   Transactional library to use
+     * @param align     Shared memory region required alignment
+     * @param size      Size of the shared memory region to allocate
+     * @param nbworkers Number of concurrent workers
+     * @param kinds     Names of the kinds of transactions run by 'run'
     **/
-    Workload(TransactionalLibrary const& library, size_t align, size_t size): tl{library}, tm{tl, align, size} {}
+    Workload(TransactionalLibrary const& library, size_t align, size_t size, size_t nbworkers, ::std::initializer_list<char const*> kinds): tl{library}, tm{tl, align, size}, stats{kinds, nbworkers} {}
     /** Virtual destructor.
     **/
     virtual ~Workload() {};
 public:
+    /** Get the statistics of the transactions run so far by 'run'.
+     * @return Statistics
+    **/
+    Statistics const& get_statistics() const noexcept {
+        return stats;
+    }
     /** Shared memory (re)initialization.
      * @return Constant null-terminated error message, 'nullptr' for none
     **/
@@ -141,6 +292,12 @@ private:
     float   prob_long;     // Probability of running a long, read-only control transaction
     float   prob_alloc;    // Probability of running an allocation/deallocation transaction, knowing a long transaction won't run
     Barrier barrier;       // Barrier for thread synchronization during 'check'
+private:
+    /** Transaction kinds, in the order of their names in the statistics.
+    **/
+    constexpr static Statistics::Kind kind_long  = 0;
+    constexpr static Statistics::Kind kind_short = 1;
+    constexpr static Statistics::Kind kind_alloc = 2;
 public:
     /** Bank workload constructor.
      * @param library       Transactional library to use
@@ -152,14 +309,16 @@ public:
      * @param prob_long     Probability of running a long, read-only control transaction
      * @param prob_alloc    Probability of running an allocation/deallocation transaction, knowing a long transaction won't run
     **/
-    WorkloadBank(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbaccounts, size_t expnbaccounts, Balance init_balance, float prob_long, float prob_alloc): Workload{library, AccountSegment::align(), AccountSegment::size(nbaccounts)}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbaccounts{nbaccounts}, expnbaccounts{expnbaccounts}, init_balance{init_balance}, prob_long{prob_long}, prob_alloc{prob_alloc}, barrier{nbworkers} {}
+    WorkloadBank(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbaccounts, size_t expnbaccounts, Balance init_balance, float prob_long, float prob_alloc): Workload{library, AccountSegment::align(), AccountSegment::size(nbaccounts), nbworkers, {"long", "short", "alloc"}}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbaccounts{nbaccounts}, expnbaccounts{expnbaccounts}, init_balance{init_balance}, prob_long{prob_long}, prob_alloc{prob_alloc}, barrier{nbworkers} {}
 private:
     /** Long read-only transaction, summing the balance of each account.
-     * @param count Loosely-updated number of accounts
+     * @param count     Loosely-updated number of accounts
+     * @param nbretries Number of retries before the commit (output)
      * @return Whether no inconsistency has been found
     **/
-    bool long_tx(size_t& nbaccounts) const {
+    bool long_tx(size_t& nbaccounts, size_t& nbretries) const {
         return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            constexpr auto span = 256ul; // Number of accounts read per library call
             auto count = 0ul;
             auto sum   = Balance{0};
             auto start = tm.get_start();
@@ -168,22 +327,27 @@ private:
                 decltype(count) segment_count = segment.count;
                 count += segment_count;
                 sum += segment.parity;
-                for (decltype(count) i = 0; i < segment_count; ++i) {
-                    Balance local = segment.accounts[i];
-                    if (unlikely(local < 0))
-                        return false;
-                    sum += local;
+                for (decltype(count) i = 0; i < segment_count; i += span) { // One read per span of accounts
+                    Balance local[span];
+                    auto length = ::std::min(segment_count - i, span);
+                    segment.accounts.read(i, length, local);
+                    for (decltype(count) j = 0; j < length; ++j) {
+                        if (unlikely(local[j] < 0))
+                            return false;
+                        sum += local[j];
+                    }
                 }
                 start = segment.next;
             }
             nbaccounts = count;
             return sum == static_cast<Balance>(init_balance * count);
-        });
+        }, nbretries);
     }
     /** Account (de)allocation transaction, adding accounts with initial balance or removing them.
-     * @param trigger Trigger level that will decide whether to allocate or deallocate
+     * @param trigger   Trigger level that will decide whether to allocate or deallocate
+     * @param nbretries Number of retries before the commit (output)
     **/
-    void alloc_tx(size_t trigger) const {
+    void alloc_tx(size_t trigger, size_t& nbretries) const {
         return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
             auto count = 0ul;
             void* prev = nullptr;
@@ -222,14 +386,15 @@ private:
                 prev  = start;
                 start = segment_next;
             }
-        });
+        }, nbretries);
     }
     /** Short read-write transaction, transferring one unit from an account to an account (potentially the same).
      * @param send_id Index of the sender account
-     * @param recv_id Index of the receiver account (potentially same as source)
+     * @param recv_id   Index of the receiver account (potentially same as source)
+     * @param nbretries Number of retries before the commit (output)
      * @return Whether the parameters were satisfying and the transaction committed on useful work
     **/
-    bool short_tx(size_t send_id, size_t recv_id) const {
+    bool short_tx(size_t send_id, size_t recv_id, size_t& nbretries) const {
         return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
             void* send_ptr = nullptr;
             void* recv_ptr = nullptr;
@@ -269,7 +434,7 @@ private:
                 recver = recver.read() + 1;
             }
             return true;
-        });
+        }, nbretries);
     }
 public:
     virtual char const* init() const {
@@ -287,28 +452,49 @@ public:
             return "Violated consistency (check that committed writes in shared memory get visible to the following transactions' reads)";
         return nullptr;
     }
-    virtual char const* run(Uid uid [[gnu::unused]], Seed seed) const {
+    virtual char const* run(Uid uid, Seed seed) const {
         ::std::minstd_rand engine{seed};
         ::std::bernoulli_distribution long_dist{prob_long};
         ::std::bernoulli_distribution alloc_dist{prob_alloc};
         ::std::gamma_distribution<float> alloc_trigger(expnbaccounts, 1);
         size_t count = nbaccounts;
+        size_t nbretries;
+        Chrono latency;
+        stats.engine_start(uid, tm);
         for (size_t cntr = 0; cntr < nbtxperwrk; ++cntr) {
             if (long_dist(engine)) { // Do a long transaction
-                if (unlikely(!long_tx(count)))
+                latency.start();
+                auto correct = long_tx(count, nbretries);
+                stats.record(uid, kind_long, latency.delta(), nbretries);
+                if (unlikely(!correct))
                     return "Violated isolation or atomicity";
             } else if (alloc_dist(engine)) { // Do an allocation transaction
-                alloc_tx(alloc_trigger(engine));
+                auto trigger = alloc_trigger(engine);
+                latency.start();
+                alloc_tx(trigger, nbretries);
+                stats.record(uid, kind_alloc, latency.delta(), nbretries);
             } else { // Do a short transaction
                 ::std::uniform_int_distribution<size_t> account{0, count - 1};
-                while (unlikely(!short_tx(account(engine), account(engine))));
+                while (true) {
+                    auto send_id = account(engine);
+                    auto recv_id = account(engine);
+                    latency.start();
+                    auto useful = short_tx(send_id, recv_id, nbretries);
+                    stats.record(uid, kind_short, latency.delta(), nbretries);
+                    if (likely(useful))
+                        break;
+                }
             }
         }
         { // Last long transaction
             size_t dummy;
-            if (!long_tx(dummy))
+            latency.start();
+            auto correct = long_tx(dummy, nbretries);
+            stats.record(uid, kind_long, latency.delta(), nbretries);
+            if (!correct)
                 return "Violated isolation or atomicity";
         }
+        stats.engine_stop(uid, tm);
         return nullptr;
     }
     virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
@@ -361,3 +547,315 @@ public:
         return nullptr;
     }
 };
+
+// -------------------------------------------------------------------------- //
+
+/** Hash map workload class.
+**/
+class WorkloadHashMap final: public Workload {
+public:
+    /** Key and value class aliases.
+    **/
+    using Key   = size_t;
+    using Value = size_t;
+private:
+    /** Shared chained entry class.
+    **/
+    class Node final {
+    private:
+        /** Dummy structure for size and alignment retrieval.
+        **/
+        struct Dummy {
+            Key   dummy0;
+            Value dummy1;
+            void* dummy2;
+        };
+    public:
+        /** Get the entry size.
+         * @return Entry size (in bytes)
+        **/
+        constexpr static auto size() noexcept {
+            return sizeof(Dummy);
+        }
+    public:
+        Shared<Key>     key; // Key of the entry
+        Shared<Value> value; // Value of the entry
+        Shared<Node*>  next; // Next entry of the same bucket
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Node(Node const&) = delete;
+        Node& operator=(Node const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Block base address
+        **/
+        Node(Transaction& tx, void* address): key{tx, address}, value{tx, key.after()}, next{tx, value.after()} {}
+    };
+    /** Shared bucket class, the buckets being contiguous in the first segment.
+    **/
+    class Bucket final {
+    private:
+        /** Dummy structure for size and alignment retrieval.
+        **/
+        struct Dummy {
+            void*  dummy0;
+            size_t dummy1;
+        };
+    public:
+        /** Get the bucket size.
+         * @return Bucket size (in bytes)
+        **/
+        constexpr static auto size() noexcept {
+            return sizeof(Dummy);
+        }
+        /** Get the bucket alignment.
+         * @return Bucket alignment (in bytes)
+        **/
+        constexpr static auto align() noexcept {
+            return alignof(Dummy);
+        }
+    public:
+        Shared<Node*>   head; // First entry of the chain
+        Shared<size_t> count; // Number of entries in the chain
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Bucket(Bucket const&) = delete;
+        Bucket& operator=(Bucket const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Bucket address
+        **/
+        Bucket(Transaction& tx, void* address): head{tx, address}, count{tx, head.after()} {}
+    };
+private:
+    size_t  nbworkers;   // Number of concurrent workers
+    size_t  nbtxperwrk;  // Number of transactions per worker
+    size_t  nbbuckets;   // Number of buckets
+    size_t  nbkeys;      // Number of keys drawn by the workers, twice the expected number of entries
+    float   prob_get;    // Probability of running a lookup transaction
+    float   prob_put;    // Probability of running an insertion (or update) transaction, removal otherwise
+    Barrier barrier;     // Barrier for thread synchronization during 'check'
+    mutable size_t checked;        // Number of entries counted by the first step of 'check'
+    mutable char const* checkerr;  // Error found by the first step of 'check', 'nullptr' for none
+private:
+    /** Transaction kinds, in the order of their names in the statistics.
+    **/
+    constexpr static Statistics::Kind kind_get    = 0;
+    constexpr static Statistics::Kind kind_put    = 1;
+    constexpr static Statistics::Kind kind_remove = 2;
+public:
+    /** Hash map workload constructor.
+     * @param library     Transactional library to use
+     * @param nbworkers   Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk  Number of transactions per worker
+     * @param nbbuckets   Number of buckets
+     * @param load_factor Expected average number of entries per bucket (half the keys drawn are expected in the map)
+     * @param prob_get    Probability of running a lookup transaction
+     * @param prob_put    Probability of running an insertion (or update) transaction, a removal transaction running otherwise
+    **/
+    WorkloadHashMap(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbbuckets, float load_factor, float prob_get, float prob_put): Workload{library, Bucket::align(), nbbuckets * Bucket::size(), nbworkers, {"get", "put", "remove"}}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbbuckets{nbbuckets}, nbkeys{::std::max(static_cast<size_t>(2.f * load_factor * static_cast<float>(nbbuckets)), size_t{1})}, prob_get{prob_get}, prob_put{prob_put}, barrier{nbworkers}, checked{0}, checkerr{nullptr} {}
+private:
+    /** Get the bucket of a key.
+     * @param key Key to locate
+     * @return Bucket address in shared memory
+    **/
+    void* bucket_of(Key key) const noexcept {
+        auto hash = static_cast<uint64_t>(key) * UINT64_C(0x9e3779b97f4a7c15); // Fibonacci hashing
+        return reinterpret_cast<char*>(tm.get_start()) + static_cast<size_t>((hash >> 32) % nbbuckets) * Bucket::size();
+    }
+    /** Get the value every entry of a key holds.
+     * @param key Key of the entry
+     * @return Value of the entry
+    **/
+    constexpr static Value value_of(Key key) noexcept {
+        return ~key;
+    }
+    /** Lookup transaction, walking the chain of the key's bucket.
+     * @param key       Key to look up
+     * @param found     Whether the key was found (output)
+     * @param nbretries Number of retries before the commit (output)
+     * @return Whether no inconsistency has been found
+    **/
+    bool get_tx(Key key, bool& found, size_t& nbretries) const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            Bucket bucket{tx, bucket_of(key)};
+            Node* address = bucket.head;
+            while (address) {
+                Node node{tx, address};
+                if (node.key == key) {
+                    found = true;
+                    return node.value == value_of(key);
+                }
+                address = node.next;
+            }
+            found = false;
+            return true;
+        }, nbretries);
+    }
+    /** Insertion transaction, appending an entry to the chain of the key's bucket, or rewriting its value if already present.
+     * @param key       Key to insert
+     * @param nbretries Number of retries before the commit (output)
+    **/
+    void put_tx(Key key, size_t& nbretries) const {
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Bucket bucket{tx, bucket_of(key)};
+            void* link = bucket.head.get(); // Address of the pointer to the current entry
+            while (true) {
+                Shared<Node*> next{tx, link};
+                Node* address = next;
+                if (!address) { // Not found, append
+                    Node node{tx, next.alloc(Node::size())};
+                    node.key   = key;
+                    node.value = value_of(key);
+                    bucket.count = bucket.count + 1;
+                    return;
+                }
+                Node node{tx, address};
+                if (node.key == key) { // Found, update
+                    node.value = value_of(key);
+                    return;
+                }
+                link = node.next.get();
+            }
+        }, nbretries);
+    }
+    /** Removal transaction, unlinking and freeing the entry of the key if present.
+     * @param key       Key to remove
+     * @param nbretries Number of retries before the commit (output)
+    **/
+    void remove_tx(Key key, size_t& nbretries) const {
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Bucket bucket{tx, bucket_of(key)};
+            void* link = bucket.head.get(); // Address of the pointer to the current entry
+            while (true) {
+                Shared<Node*> next{tx, link};
+                Node* address = next;
+                if (!address) // Not found
+                    return;
+                Node node{tx, address};
+                if (node.key == key) { // Found, unlink
+                    Node* after = node.next;
+                    next.free();
+                    next = after;
+                    bucket.count = bucket.count - 1;
+                    return;
+                }
+                link = node.next.get();
+            }
+        }, nbretries);
+    }
+    /** Check the invariants of every bucket in one read-only transaction: the entries of a chain are as many as its count, have
+     * distinct keys that belong to that bucket, and hold the value of their key.
+     * @param count Total number of entries (output)
+     * @return Constant null-terminated error message, 'nullptr' for none
+    **/
+    char const* verify(size_t& count) const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) -> char const* {
+            ::std::vector<Key> keys;
+            count = 0;
+            for (size_t i = 0; i < nbbuckets; ++i) {
+                auto address = reinterpret_cast<char*>(tm.get_start()) + i * Bucket::size();
+                Bucket bucket{tx, address};
+                keys.clear();
+                for (Node* entry = bucket.head; entry;) {
+                    Node node{tx, entry};
+                    Key key = node.key;
+                    if (unlikely(bucket_of(key) != address || node.value != value_of(key)))
+                        return "Violated consistency, isolation or atomicity";
+                    keys.push_back(key);
+                    if (unlikely(keys.size() > nbkeys + nbworkers)) // Cycle
+                        return "Violated consistency, isolation or atomicity";
+                    entry = node.next;
+                }
+                ::std::sort(keys.begin(), keys.end());
+                if (unlikely(keys.size() != bucket.count || ::std::adjacent_find(keys.begin(), keys.end()) != keys.end()))
+                    return "Violated consistency, isolation or atomicity";
+                count += keys.size();
+            }
+            return nullptr;
+        });
+    }
+public:
+    virtual char const* init() const {
+        size_t nbretries;
+        for (Key key = 0; key < nbkeys; key += 2) // Half the keys, put by every worker (idempotent)
+            put_tx(key, nbretries);
+        auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            Bucket bucket{tx, bucket_of(0)};
+            Node* address = bucket.head;
+            return address != nullptr;
+        });
+        if (unlikely(!correct))
+            return "Violated consistency (check that committed writes in shared memory get visible to the following transactions' reads)";
+        return nullptr;
+    }
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::uniform_real_distribution<float> kind_dist{0.f, 1.f};
+        ::std::uniform_int_distribution<Key> key_dist{0, nbkeys - 1};
+        size_t nbretries;
+        Chrono latency;
+        stats.engine_start(uid, tm);
+        for (size_t cntr = 0; cntr < nbtxperwrk; ++cntr) {
+            auto draw = kind_dist(engine);
+            auto key  = key_dist(engine);
+            if (draw < prob_get) { // Do a lookup
+                bool found;
+                latency.start();
+                auto correct = get_tx(key, found, nbretries);
+                stats.record(uid, kind_get, latency.delta(), nbretries);
+                if (unlikely(!correct))
+                    return "Violated isolation or atomicity";
+            } else if (draw < prob_get + prob_put) { // Do an insertion
+                latency.start();
+                put_tx(key, nbretries);
+                stats.record(uid, kind_put, latency.delta(), nbretries);
+            } else { // Do a removal
+                latency.start();
+                remove_tx(key, nbretries);
+                stats.record(uid, kind_remove, latency.delta(), nbretries);
+            }
+        }
+        stats.engine_stop(uid, tm);
+        return nullptr;
+    }
+    virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
+        constexpr size_t nbkeysperwrk = 16;
+        barrier.sync();
+        if (uid == 0) // Invariants before the check
+            checkerr = verify(checked);
+        barrier.sync();
+        if (unlikely(checkerr)) // Every worker returns here
+            return checkerr;
+        // Insert then remove keys of this worker only (outside the drawn keys, but sharing their buckets)
+        char const* error = nullptr;
+        size_t nbretries;
+        auto first = nbkeys + uid * nbkeysperwrk;
+        for (auto key = first; key < first + nbkeysperwrk; ++key)
+            put_tx(key, nbretries);
+        for (auto key = first; key < first + nbkeysperwrk && !error; ++key) {
+            bool found;
+            if (unlikely(!get_tx(key, found, nbretries) || !found))
+                error = "Violated consistency, isolation or atomicity";
+        }
+        for (auto key = first; key < first + nbkeysperwrk; ++key)
+            remove_tx(key, nbretries);
+        for (auto key = first; key < first + nbkeysperwrk && !error; ++key) {
+            bool found;
+            if (unlikely(!get_tx(key, found, nbretries) || found))
+                error = "Violated consistency, isolation or atomicity";
+        }
+        barrier.sync();
+        if (unlikely(error))
+            return error;
+        if (uid == 0) { // Invariants after the check, with the same number of entries
+            size_t count;
+            error = verify(count);
+            if (unlikely(!error && count != checked))
+                error = "Violated consistency, isolation or atomicity";
+        }
+        return error;
+    }
+};
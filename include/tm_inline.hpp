@@ -0,0 +1,961 @@
+/**
+ * @file   tm_inline.hpp
+ * @author [...]
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * Header-only TL2-style word-based transaction manager (C++ version).
+ *
+ * It offers the interface of 'tm.hpp' (without the 'tm_' prefix, in namespace
+ * 'STMInline'), plus templated 'read<Type>'/'write<Type>' that are resolved at
+ * compile time: a trivially copyable value of the size of an 8-byte word, in a
+ * region of 8-byte words, is read with one load between two checks of its
+ * versioned lock, and written with one store in the write set; other types go
+ * through the generic, range-based operations.
+ *
+ * As in 'template/tm.c', a global version clock orders the commits, read-only
+ * transactions are invisible (their handle encodes their read version), and
+ * read-write transactions buffer their writes until commit, indexing them with
+ * an open-addressed hash table kept between transactions. Every transaction
+ * announces its read version in an epoch slot; freed segments are retired with
+ * the write version of the transaction that freed them, and given back once no
+ * announced read version is below it.
+**/
+
+#pragma once
+
+// External headers
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include <sched.h>
+
+// -------------------------------------------------------------------------- //
+
+/** Define a proposition as likely true.
+ * @param prop Proposition
+**/
+#undef likely
+#ifdef __GNUC__
+    #define likely(prop) \
+        __builtin_expect((prop) ? 1 : 0, 1)
+#else
+    #define likely(prop) \
+        (prop)
+#endif
+
+/** Define a proposition as likely false.
+ * @param prop Proposition
+**/
+#undef unlikely
+#ifdef __GNUC__
+    #define unlikely(prop) \
+        __builtin_expect((prop) ? 1 : 0, 0)
+#else
+    #define unlikely(prop) \
+        (prop)
+#endif
+
+// -------------------------------------------------------------------------- //
+namespace STMInline {
+
+using shared_t = void*;
+constexpr static shared_t invalid_shared = nullptr; // Invalid shared memory region
+
+using tx_t = uintptr_t;
+constexpr static tx_t invalid_tx = ~(tx_t(0)); // Invalid transaction constant
+
+enum class Alloc: int {
+    success = 0, // Allocation successful and the TX can continue
+    abort   = 1, // TX was aborted and could be retried
+    nomem   = 2  // Memory allocation failed but TX was not aborted
+};
+
+namespace Detail {
+
+// Compile-time configuration
+constexpr static size_t lock_table_bits = 20; // Log2 of the number of versioned locks in the lock table
+constexpr static size_t epoch_slot_bits = 8;  // Log2 of the number of slots where running transactions announce their read version
+constexpr static size_t reclaim_batch   = 16; // Number of retired segments that triggers a reclamation pass
+
+/** Versioned lock word, i.e. version (upper bits) and lock bit (lowest bit).
+**/
+using Word = uint_fast64_t;
+using Lock = ::std::atomic<Word>;
+
+/** Epoch slot value when no transaction uses it.
+**/
+constexpr static uint_fast64_t epoch_free = UINT_FAST64_MAX;
+
+/** Check whether a versioned lock word is locked.
+ * @param word Versioned lock word
+ * @return Whether the word is locked
+**/
+constexpr static bool locked(Word word) noexcept {
+    return (word & 1) != 0;
+}
+
+/** Get the version of a versioned lock word.
+ * @param word Versioned lock word
+ * @return Version
+**/
+constexpr static uint_fast64_t version(Word word) noexcept {
+    return word >> 1;
+}
+
+/** Whether a type is accessed with the one-word fast paths.
+ * @param Type Accessed type
+**/
+template<class Type> constexpr static bool is_word = ::std::is_trivially_copyable_v<Type> && sizeof(Type) == sizeof(uint64_t);
+
+/** Segment header, preceding the memory of every segment.
+**/
+struct Segment {
+    Segment* prev;       // Previous segment in the chain
+    Segment* next;       // Next segment in the chain
+    uint_fast64_t stamp; // Write version of the transaction that freed the segment, once retired
+public:
+    /** Make the segment an empty chain.
+    **/
+    void reset() noexcept {
+        prev = this;
+        next = this;
+    }
+    /** Insert the segment in a chain.
+     * @param base Chain in which to insert the segment
+    **/
+    void insert(Segment* base) noexcept {
+        prev = base->prev;
+        next = base;
+        base->prev->next = this;
+        base->prev = this;
+    }
+    /** Remove the segment from its chain.
+    **/
+    void remove() noexcept {
+        prev->next = next;
+        next->prev = prev;
+    }
+};
+
+/** Epoch slot, where a running transaction announces its read version.
+**/
+struct Epoch {
+    alignas(64) ::std::atomic<uint_fast64_t> rv; // Read version announced by the running transaction, 'epoch_free' if none
+};
+
+/** Shared memory region.
+**/
+struct Region {
+    alignas(64) ::std::atomic<uint_fast64_t> clock; // Global version clock
+    alignas(64) ::std::unique_ptr<Lock[]> locks; // Versioned lock table
+    ::std::unique_ptr<Epoch[]> slots; // Epoch slots
+    size_t align;       // Claimed alignment of the shared memory region (in bytes), i.e. word size
+    size_t word_shift;  // Log2 of the alignment
+    size_t align_alloc; // Actual alignment of the memory allocations (in bytes)
+    size_t header;      // Size of the segment header, rounded up to the allocation alignment (in bytes)
+    void*  start;       // Start of the shared memory region
+    size_t size;        // Size of the shared memory region (in bytes)
+    alignas(64) ::std::atomic<size_t> nbslots; // Number of epoch slots ever used
+    alignas(64) ::std::mutex chains; // Protect the segment chains
+    Segment allocated;  // Published segments
+    Segment retired;    // Freed segments, until no transaction can reach them
+    size_t nbretired;   // Number of segments in 'retired'
+    size_t threshold;   // Number of retired segments from which to try giving them back, at least twice the number left by the last pass
+public:
+    /** Get the versioned lock protecting a given word.
+     * @param addr Word address
+     * @return Associated versioned lock
+    **/
+    Lock& lock(uintptr_t addr) const noexcept {
+        return locks[(addr >> word_shift) & ((size_t{1} << lock_table_bits) - 1)];
+    }
+    /** Allocate a zeroed segment, not yet published.
+     * @param size Size of the segment (in bytes)
+     * @return Segment, 'nullptr' on failure
+    **/
+    Segment* allocate(size_t size) const noexcept {
+        size_t total = (header + size + align_alloc - 1) & ~(align_alloc - 1);
+        auto segment = static_cast<Segment*>(::std::aligned_alloc(align_alloc, total));
+        if (unlikely(!segment))
+            return nullptr;
+        ::std::memset(segment, 0, total);
+        return segment;
+    }
+    /** Get the memory of a segment.
+     * @param segment Segment
+     * @return First byte of the segment's memory
+    **/
+    void* memory(Segment* segment) const noexcept {
+        return reinterpret_cast<char*>(segment) + header;
+    }
+    /** Get the segment of a segment's memory.
+     * @param addr First byte of the segment's memory
+     * @return Segment
+    **/
+    Segment* segment(void* addr) const noexcept {
+        return reinterpret_cast<Segment*>(static_cast<char*>(addr) - header);
+    }
+    /** Announce the read version of a starting transaction in a free epoch slot.
+     * @param rv Set to the read version taken
+     * @return Slot used, to release at the end of the transaction
+    **/
+    size_t enter(uint_fast64_t& rv) noexcept {
+        static ::std::atomic<size_t> next_hint{0};
+        static thread_local size_t hint = next_hint.fetch_add(1, ::std::memory_order_relaxed);
+        constexpr size_t count = size_t{1} << epoch_slot_bits;
+        auto slot = hint % count;
+        auto version = clock.load();
+        while (true) { // Claim a free slot
+            auto expected = epoch_free;
+            if (likely(slots[slot].rv.compare_exchange_weak(expected, version)))
+                break;
+            slot = (slot + 1) % count;
+            if (slot == hint % count)
+                sched_yield();
+        }
+        auto used = nbslots.load(::std::memory_order_relaxed);
+        while (used <= slot && !nbslots.compare_exchange_weak(used, slot + 1));
+        while (true) { // Make sure the announced version is visible to any reclaiming transaction (see 'oldest')
+            auto current = clock.load();
+            if (likely(current == version))
+                break;
+            version = current;
+            slots[slot].rv.store(version);
+        }
+        rv = version;
+        return slot;
+    }
+    /** Withdraw the read version of an ending transaction.
+     * @param slot Epoch slot to release
+    **/
+    void leave(size_t slot) noexcept {
+        slots[slot].rv.store(epoch_free, ::std::memory_order_release);
+    }
+    /** Get the lowest read version any transaction may use, now or in the future.
+     * @return Lowest read version
+    **/
+    uint_fast64_t oldest() const noexcept {
+        auto oldest = clock.load(); // A read version announced after the scan below is at least this version
+        auto used = nbslots.load();
+        for (size_t i = 0; i < used; ++i) {
+            auto rv = slots[i].rv.load();
+            if (rv < oldest)
+                oldest = rv;
+        }
+        return oldest;
+    }
+    /** Publish the segments allocated by a committed transaction and retire the ones it freed.
+     * @param allocs Segments allocated by the transaction
+     * @param frees  Segments freed by the transaction
+     * @param stamp  Write version of the transaction
+     * @return Whether enough segments are retired to try giving them back (see 'reclaim')
+    **/
+    bool publish(::std::vector<Segment*> const& allocs, ::std::vector<Segment*> const& frees, uint_fast64_t stamp) noexcept {
+        ::std::lock_guard<::std::mutex> guard{chains};
+        for (auto segment: allocs)
+            segment->insert(&allocated);
+        for (auto segment: frees) {
+            segment->stamp = stamp;
+            segment->remove();
+            segment->insert(&retired);
+        }
+        nbretired += frees.size();
+        return nbretired >= threshold;
+    }
+    /** Free the retired segments no transaction can reach anymore.
+    **/
+    void reclaim() noexcept {
+        auto bound = oldest();
+        Segment* stale = nullptr;
+        {
+            ::std::lock_guard<::std::mutex> guard{chains};
+            for (auto segment = retired.next; segment != &retired;) {
+                auto next = segment->next;
+                if (segment->stamp <= bound) { // Every transaction that began before the segment was freed has ended
+                    segment->remove();
+                    segment->next = stale;
+                    stale = segment;
+                    --nbretired;
+                }
+                segment = next;
+            }
+            threshold = 2 * nbretired > reclaim_batch ? 2 * nbretired : reclaim_batch; // Amortize the scans while a long transaction holds the segments back
+        }
+        while (stale) {
+            auto next = stale->next;
+            ::std::free(stale);
+            stale = next;
+        }
+    }
+};
+
+/** Open-addressed (linear probing) hash index of the entries of a set, emptied in constant time by changing generation.
+**/
+class Index {
+private:
+    struct Slot {
+        uint32_t entry; // Index of the entry in the set
+        uint32_t gen;   // Generation the slot belongs to, slots of other generations are empty
+    };
+    ::std::unique_ptr<Slot[]> slots; // Table of '2^bits' slots
+    size_t   bits = 0; // Log2 of the number of slots, 0 if not allocated
+    uint32_t gen  = 1; // Current generation
+public:
+    /** Hash a key.
+     * @param key Key
+     * @return Hash value, top bits for the index and middle bits for the bloom filter
+    **/
+    static uint64_t hash(uintptr_t key) noexcept {
+        return static_cast<uint64_t>(key) * UINT64_C(0x9e3779b97f4a7c15); // Fibonacci hashing
+    }
+    /** Find the entry of a key.
+     * @param key    Key to look up
+     * @param size   Number of entries in the set
+     * @param key_of Callable returning the key of an entry of the set
+     * @return Index of the entry, 'size' if not found
+    **/
+    template<class KeyOf> size_t find(uintptr_t key, size_t size, KeyOf&& key_of) const noexcept {
+        if (size == 0)
+            return size;
+        size_t mask = (size_t{1} << bits) - 1;
+        for (size_t i = hash(key) >> (64 - bits);; i = (i + 1) & mask) {
+            auto slot = slots[i];
+            if (slot.gen != gen)
+                return size;
+            if (key_of(slot.entry) == key)
+                return slot.entry;
+        }
+    }
+    /** Index an entry, the index having room for it.
+     * @param key   Key of the entry
+     * @param entry Index of the entry in the set
+    **/
+    void insert(uintptr_t key, size_t entry) noexcept {
+        size_t mask = (size_t{1} << bits) - 1;
+        size_t i = hash(key) >> (64 - bits);
+        while (slots[i].gen == gen)
+            i = (i + 1) & mask;
+        slots[i] = Slot{static_cast<uint32_t>(entry), gen};
+    }
+    /** Make sure the index can hold a given number of entries, throw on allocation failure.
+     * @param need   Required number of entries
+     * @param size   Number of entries in the set, re-indexed if the table grows
+     * @param key_of Callable returning the key of an entry of the set
+    **/
+    template<class KeyOf> void reserve(size_t need, size_t size, KeyOf&& key_of) {
+        if (likely(2 * need <= (size_t{1} << bits) && slots)) // Load factor at most 1/2
+            return;
+        size_t nbits = bits > 0 ? bits : 5;
+        while ((size_t{1} << nbits) < 2 * need)
+            ++nbits;
+        if (unlikely(nbits > 32)) // Entry indices are 32-bit
+            throw ::std::bad_alloc{};
+        slots.reset(new Slot[size_t{1} << nbits]());
+        bits = nbits;
+        gen  = 1;
+        for (size_t i = 0; i < size; ++i) // Rehash
+            insert(key_of(i), i);
+    }
+    /** Empty the index, keeping its table.
+    **/
+    void clear() noexcept {
+        if (unlikely(++gen == 0)) { // Generation wrap-around, actually empty the slots
+            if (slots)
+                ::std::memset(slots.get(), 0, sizeof(Slot) << bits);
+            gen = 1;
+        }
+    }
+};
+
+/** Write set entry.
+**/
+struct Entry {
+    uintptr_t addr; // Target word address
+    Lock*     lock; // Associated versioned lock
+};
+
+/** Versioned lock held during commit.
+**/
+struct Held {
+    Lock* lock; // Held versioned lock
+    Word  word; // Word before locking
+};
+
+/** Read-write transaction descriptor.
+**/
+struct Transaction {
+    uint_fast64_t rv = 0; // Read version, i.e. clock value at begin
+    size_t slot = 0;      // Epoch slot where the read version is announced
+    bool busy = false;    // Whether the descriptor is in use
+    ::std::vector<Lock*> rset; // Versioned locks of the read words
+    ::std::vector<Entry> wset; // Written words, in insertion order
+    ::std::vector<unsigned char> values; // Buffered values, one word per write set entry
+    Index index;               // Write set entries by address
+    uint64_t bloom = 0;        // One-hash bloom filter of the written addresses
+    ::std::vector<Held> held;  // Locks held during commit
+    Index held_index;          // Held locks by lock address
+    ::std::vector<Segment*> allocs; // Segments allocated by the transaction, published at commit
+    ::std::vector<Segment*> frees;  // Segments freed by the transaction, retired at commit
+public:
+    /** Get the bloom filter bit of a word address.
+     * @param addr Word address
+     * @return Bloom filter bit
+    **/
+    static uint64_t bloom_bit(uintptr_t addr) noexcept {
+        return uint64_t{1} << (Index::hash(addr) >> 58);
+    }
+    /** Find the write set entry of a given word.
+     * @param addr Word address
+     * @return Index of the entry, 'wset.size()' if not found
+    **/
+    size_t find(uintptr_t addr) const noexcept {
+        if (likely((bloom & bloom_bit(addr)) == 0)) // Common case: never written
+            return wset.size();
+        return index.find(addr, wset.size(), [this](size_t i) noexcept { return wset[i].addr; });
+    }
+    /** Add a write set entry, throw on allocation failure.
+     * @param addr  Word address
+     * @param lock  Associated versioned lock
+     * @param align Word size (in bytes)
+     * @return Buffer of the value of the new entry
+    **/
+    unsigned char* insert(uintptr_t addr, Lock* lock, size_t align) {
+        auto pos = wset.size();
+        index.reserve(pos + 1, pos, [this](size_t i) noexcept { return wset[i].addr; });
+        wset.push_back(Entry{addr, lock});
+        values.resize(values.size() + align);
+        index.insert(addr, pos);
+        bloom |= bloom_bit(addr);
+        return values.data() + pos * align;
+    }
+    /** Make sure the transaction can hold a given number of locks, throw on allocation failure.
+     * @param need Required number of locks
+    **/
+    void reserve_held(size_t need) {
+        held.reserve(need);
+        held_index.reserve(need, held.size(), [this](size_t i) noexcept { return reinterpret_cast<uintptr_t>(held[i].lock); });
+    }
+    /** Record a lock acquired by the transaction, the capacity being reserved (see 'reserve_held').
+     * @param lock Acquired versioned lock
+     * @param word Word before locking
+    **/
+    void hold(Lock* lock, Word word) noexcept {
+        held_index.insert(reinterpret_cast<uintptr_t>(lock), held.size());
+        held.push_back(Held{lock, word});
+    }
+    /** Check whether the transaction holds a given versioned lock.
+     * @param lock Versioned lock
+     * @return Held entry, 'nullptr' if not held
+    **/
+    Held const* holds(Lock const* lock) const noexcept {
+        auto pos = held_index.find(reinterpret_cast<uintptr_t>(lock), held.size(), [this](size_t i) noexcept { return reinterpret_cast<uintptr_t>(held[i].lock); });
+        return pos < held.size() ? &held[pos] : nullptr;
+    }
+    /** Release the locks held by the transaction, restoring their previous word.
+    **/
+    void unlock() noexcept {
+        for (auto&& entry: held)
+            entry.lock->store(entry.word, ::std::memory_order_release);
+        held.clear();
+        held_index.clear();
+    }
+    /** Reset the descriptor for the next transaction, keeping the buffers.
+    **/
+    void reset() noexcept {
+        rset.clear();
+        wset.clear();
+        values.clear();
+        index.clear();
+        bloom = 0;
+        held.clear();
+        held_index.clear();
+        allocs.clear();
+        frees.clear();
+    }
+};
+
+/** Get the home descriptor slot of the calling thread.
+ * @return Home descriptor, destroyed at thread exit
+**/
+inline ::std::unique_ptr<Transaction>& home() noexcept {
+    static thread_local ::std::unique_ptr<Transaction> descriptor;
+    return descriptor;
+}
+
+/** Check whether a transaction handle is read-only.
+ * @param tx Transaction handle
+ * @return Whether the handle is the one of an (invisible) read-only transaction
+**/
+constexpr static bool is_ro(tx_t tx) noexcept {
+    return (tx & 1) != 0;
+}
+
+/** Make the handle of a read-only transaction.
+ * @param rv   Read version
+ * @param slot Epoch slot where the read version is announced
+ * @return Transaction handle
+**/
+constexpr static tx_t make_ro(uint_fast64_t rv, size_t slot) noexcept {
+    return static_cast<tx_t>((((rv << epoch_slot_bits) | slot) << 1) | 1);
+}
+
+/** Get the read version of a read-only transaction.
+ * @param tx Read-only transaction handle
+ * @return Read version
+**/
+constexpr static uint_fast64_t ro_rv(tx_t tx) noexcept {
+    return static_cast<uint_fast64_t>(tx >> (epoch_slot_bits + 1));
+}
+
+/** Get the epoch slot of a read-only transaction.
+ * @param tx Read-only transaction handle
+ * @return Epoch slot
+**/
+constexpr static size_t ro_slot(tx_t tx) noexcept {
+    return static_cast<size_t>((tx >> 1) & ((size_t{1} << epoch_slot_bits) - 1));
+}
+
+/** Release a transaction descriptor and its epoch slot.
+ * @param region Shared memory region
+ * @param tx     Transaction to release
+**/
+inline void release(Region* region, Transaction* tx) noexcept {
+    region->leave(tx->slot);
+    if (unlikely(tx != home().get())) { // Concurrent transactions in the same thread
+        delete tx;
+        return;
+    }
+    tx->reset();
+    tx->busy = false;
+}
+
+/** Abort a transaction, undoing its allocations and releasing it.
+ * @param region Shared memory region
+ * @param tx     Transaction to abort
+**/
+inline void abort(Region* region, Transaction* tx) noexcept {
+    tx->unlock();
+    for (auto segment: tx->allocs) // Never reachable by other transactions
+        ::std::free(segment);
+    release(region, tx);
+}
+
+/** Acquire a versioned lock for the commit of a transaction.
+ * @param tx   Committing transaction
+ * @param lock Versioned lock to acquire
+ * @return Whether the lock is now held by the transaction
+**/
+inline bool acquire(Transaction* tx, Lock* lock) noexcept {
+    auto word = lock->load(::std::memory_order_relaxed);
+    if (locked(word))
+        return tx->holds(lock) != nullptr;
+    if (unlikely(!lock->compare_exchange_strong(word, word | 1, ::std::memory_order_acquire, ::std::memory_order_relaxed)))
+        return false;
+    tx->hold(lock, word);
+    return true;
+}
+
+/** Validate the read set of a committing transaction.
+ * @param tx Transaction to validate
+ * @return Whether every read word is still at a version no greater than the read version
+**/
+inline bool validate(Transaction const* tx) noexcept {
+    for (auto lock: tx->rset) {
+        auto word = lock->load(::std::memory_order_acquire);
+        if (locked(word)) {
+            auto held = tx->holds(lock);
+            if (!held)
+                return false;
+            word = held->word;
+        }
+        if (version(word) > tx->rv)
+            return false;
+    }
+    return true;
+}
+
+/** Read one word, checking its versioned lock before and after.
+ * @param region Shared memory region
+ * @param rv     Read version
+ * @param source Source word (in shared memory)
+ * @param target Target word (in private memory)
+ * @param lock   Set to the versioned lock of the word
+ * @return Whether the read is consistent with the read version
+**/
+inline bool read_word(Region const* region, uint_fast64_t rv, void const* source, void* target, Lock*& lock) noexcept {
+    lock = &region->lock(reinterpret_cast<uintptr_t>(source));
+    auto before = lock->load(::std::memory_order_acquire);
+    ::std::memcpy(target, source, region->align);
+    ::std::atomic_thread_fence(::std::memory_order_acquire);
+    auto after = lock->load(::std::memory_order_relaxed);
+    return !locked(before) && before == after && version(before) <= rv;
+}
+
+}
+// -------------------------------------------------------------------------- //
+
+/** Create (i.e. allocate + init) a new shared memory region, with one first non-free-able allocated segment of the requested size and alignment.
+ * @param size  Size of the first shared segment of memory to allocate (in bytes), must be a positive multiple of the alignment
+ * @param align Alignment (in bytes, must be a power of 2) that the shared memory region must support
+ * @return Opaque shared memory region handle, 'invalid_shared' on failure
+**/
+inline shared_t create(size_t size, size_t align) noexcept {
+    auto region = new (::std::nothrow) Detail::Region;
+    if (unlikely(!region))
+        return invalid_shared;
+    region->locks.reset(new (::std::nothrow) Detail::Lock[size_t{1} << Detail::lock_table_bits]());
+    if (unlikely(!region->locks)) {
+        delete region;
+        return invalid_shared;
+    }
+    region->slots.reset(new (::std::nothrow) Detail::Epoch[size_t{1} << Detail::epoch_slot_bits]);
+    if (unlikely(!region->slots)) {
+        delete region;
+        return invalid_shared;
+    }
+    for (size_t i = 0; i < (size_t{1} << Detail::epoch_slot_bits); ++i)
+        region->slots[i].rv.store(Detail::epoch_free, ::std::memory_order_relaxed);
+    region->nbslots.store(0, ::std::memory_order_relaxed);
+    region->clock.store(0, ::std::memory_order_relaxed);
+    region->align       = align;
+    region->word_shift  = 0;
+    while ((size_t{1} << region->word_shift) < align)
+        ++(region->word_shift);
+    region->align_alloc = align < sizeof(void*) ? sizeof(void*) : align;
+    region->header      = (sizeof(Detail::Segment) + region->align_alloc - 1) & ~(region->align_alloc - 1);
+    region->size        = size;
+    region->allocated.reset();
+    region->retired.reset();
+    region->nbretired   = 0;
+    region->threshold   = Detail::reclaim_batch;
+    auto segment = region->allocate(size);
+    if (unlikely(!segment)) {
+        delete region;
+        return invalid_shared;
+    }
+    segment->insert(&region->allocated);
+    region->start = region->memory(segment);
+    return region;
+}
+
+/** Destroy (i.e. clean-up + free) a given shared memory region.
+ * @param shared Shared memory region to destroy, with no running transaction
+**/
+inline void destroy(shared_t shared) noexcept {
+    auto region = static_cast<Detail::Region*>(shared);
+    for (auto chain: {&region->allocated, &region->retired}) {
+        for (auto segment = chain->next; segment != chain;) {
+            auto next = segment->next;
+            ::std::free(segment);
+            segment = next;
+        }
+    }
+    delete region;
+}
+
+/** [thread-safe] Return the start address of the first allocated segment in the shared memory region.
+ * @param shared Shared memory region to query
+ * @return Start address of the first allocated segment
+**/
+inline void* start(shared_t shared) noexcept {
+    return static_cast<Detail::Region*>(shared)->start;
+}
+
+/** [thread-safe] Return the size (in bytes) of the first allocated segment of the shared memory region.
+ * @param shared Shared memory region to query
+ * @return First allocated segment size
+**/
+inline size_t size(shared_t shared) noexcept {
+    return static_cast<Detail::Region*>(shared)->size;
+}
+
+/** [thread-safe] Return the alignment (in bytes) of the memory accesses on the given shared memory region.
+ * @param shared Shared memory region to query
+ * @return Alignment used globally
+**/
+inline size_t align(shared_t shared) noexcept {
+    return static_cast<Detail::Region*>(shared)->align;
+}
+
+/** [thread-safe] Begin a new transaction on the given shared memory region.
+ * @param shared Shared memory region to start a transaction on
+ * @param is_ro  Whether the transaction is read-only
+ * @return Opaque transaction ID, 'invalid_tx' on failure
+**/
+inline tx_t begin(shared_t shared, bool is_ro) noexcept {
+    auto region = static_cast<Detail::Region*>(shared);
+    uint_fast64_t rv;
+    auto slot = region->enter(rv);
+    if (is_ro)
+        return Detail::make_ro(rv, slot);
+    auto& home = Detail::home();
+    Detail::Transaction* tx;
+    if (likely(home && !home->busy)) {
+        tx = home.get();
+    } else {
+        tx = new (::std::nothrow) Detail::Transaction;
+        if (unlikely(!tx)) {
+            region->leave(slot);
+            return invalid_tx;
+        }
+        if (!home) // First transaction of the thread
+            home.reset(tx);
+    }
+    tx->busy = true;
+    tx->rv   = rv;
+    tx->slot = slot;
+    return reinterpret_cast<tx_t>(tx);
+}
+
+/** [thread-safe] End the given transaction.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to end
+ * @return Whether the whole transaction committed
+**/
+inline bool end(shared_t shared, tx_t tx) noexcept {
+    auto region = static_cast<Detail::Region*>(shared);
+    if (Detail::is_ro(tx)) { // Every read was consistent with the read version
+        region->leave(Detail::ro_slot(tx));
+        return true;
+    }
+    auto t = reinterpret_cast<Detail::Transaction*>(tx);
+    if (t->wset.empty() && t->allocs.empty() && t->frees.empty()) { // Every read was consistent with the read version
+        Detail::release(region, t);
+        return true;
+    }
+    // Lock the write set
+    try {
+        t->reserve_held(t->wset.size());
+    } catch (...) {
+        Detail::abort(region, t);
+        return false;
+    }
+    for (auto&& entry: t->wset) {
+        if (unlikely(!Detail::acquire(t, entry.lock))) {
+            Detail::abort(region, t);
+            return false;
+        }
+    }
+    // Take the write version, validate the read set if someone committed in between
+    auto wv = region->clock.fetch_add(1, ::std::memory_order_acq_rel) + 1;
+    if (wv != t->rv + 1 && unlikely(!Detail::validate(t))) {
+        Detail::abort(region, t);
+        return false;
+    }
+    // Write back, publish allocated segments and retire freed ones before releasing the locks with the new version (a later transaction may free one of them)
+    auto align = region->align;
+    for (size_t i = 0; i < t->wset.size(); ++i)
+        ::std::memcpy(reinterpret_cast<void*>(t->wset[i].addr), t->values.data() + i * align, align);
+    bool reclaim = (!t->allocs.empty() || !t->frees.empty()) && region->publish(t->allocs, t->frees, wv);
+    for (auto&& entry: t->held)
+        entry.lock->store(wv << 1, ::std::memory_order_release);
+    Detail::release(region, t);
+    if (unlikely(reclaim)) // After leaving the epoch, as this transaction does not prevent reclaiming what it freed
+        region->reclaim();
+    return true;
+}
+
+/** [thread-safe] Read operation in the given transaction, source in the shared region and target in a private region.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param source Source start address (in the shared region)
+ * @param size   Length to copy (in bytes), must be a positive multiple of the alignment
+ * @param target Target start address (in a private region)
+ * @return Whether the whole transaction can continue
+**/
+inline bool read(shared_t shared, tx_t tx, void const* source, size_t size, void* target) noexcept {
+    auto region = static_cast<Detail::Region*>(shared);
+    auto align  = region->align;
+    Detail::Lock* lock;
+    if (Detail::is_ro(tx)) {
+        auto rv = Detail::ro_rv(tx);
+        for (size_t offset = 0; offset < size; offset += align) {
+            if (unlikely(!Detail::read_word(region, rv, static_cast<char const*>(source) + offset, static_cast<char*>(target) + offset, lock))) {
+                region->leave(Detail::ro_slot(tx)); // The transaction ends here
+                return false;
+            }
+        }
+        return true;
+    }
+    auto t = reinterpret_cast<Detail::Transaction*>(tx);
+    for (size_t offset = 0; offset < size; offset += align) {
+        auto src = static_cast<char const*>(source) + offset;
+        auto dst = static_cast<char*>(target) + offset;
+        auto pos = t->find(reinterpret_cast<uintptr_t>(src));
+        if (pos < t->wset.size()) { // Read-after-write
+            ::std::memcpy(dst, t->values.data() + pos * align, align);
+            continue;
+        }
+        if (unlikely(!Detail::read_word(region, t->rv, src, dst, lock))) {
+            Detail::abort(region, t);
+            return false;
+        }
+        try {
+            t->rset.push_back(lock); // Geometric growth, the capacity is kept between transactions
+        } catch (...) {
+            Detail::abort(region, t);
+            return false;
+        }
+    }
+    return true;
+}
+
+/** [thread-safe] Write operation in the given transaction, source in a private region and target in the shared region.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param source Source start address (in a private region)
+ * @param size   Length to copy (in bytes), must be a positive multiple of the alignment
+ * @param target Target start address (in the shared region)
+ * @return Whether the whole transaction can continue
+**/
+inline bool write(shared_t shared, tx_t tx, void const* source, size_t size, void* target) noexcept {
+    auto region = static_cast<Detail::Region*>(shared);
+    auto t = reinterpret_cast<Detail::Transaction*>(tx);
+    auto align = region->align;
+    try {
+        for (size_t offset = 0; offset < size; offset += align) {
+            auto addr = reinterpret_cast<uintptr_t>(target) + offset;
+            auto pos = t->find(addr);
+            auto value = pos < t->wset.size() ? t->values.data() + pos * align : t->insert(addr, &region->lock(addr), align);
+            ::std::memcpy(value, static_cast<char const*>(source) + offset, align);
+        }
+    } catch (...) {
+        Detail::abort(region, t);
+        return false;
+    }
+    return true;
+}
+
+/** [thread-safe] Read operation of one value in the given transaction.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param source Source value (in the shared region), aligned on the alignment of the region
+ * @param target Target value (in a private region)
+ * @return Whether the whole transaction can continue
+**/
+template<class Type> inline bool read(shared_t shared, tx_t tx, Type const* source, Type& target) noexcept {
+    if constexpr (Detail::is_word<Type>) {
+        auto region = static_cast<Detail::Region*>(shared);
+        if (likely(region->align == sizeof(Type))) { // One word: one load between two checks of its versioned lock
+            auto addr = reinterpret_cast<uintptr_t>(source);
+            Detail::Transaction* t = nullptr;
+            uint_fast64_t rv;
+            if (Detail::is_ro(tx)) {
+                rv = Detail::ro_rv(tx);
+            } else {
+                t = reinterpret_cast<Detail::Transaction*>(tx);
+                auto pos = t->find(addr);
+                if (unlikely(pos < t->wset.size())) { // Read-after-write
+                    ::std::memcpy(&target, t->values.data() + pos * sizeof(Type), sizeof(Type));
+                    return true;
+                }
+                rv = t->rv;
+            }
+            auto& lock = region->lock(addr);
+            auto before = lock.load(::std::memory_order_acquire);
+            __atomic_load(const_cast<Type*>(source), &target, __ATOMIC_RELAXED);
+            ::std::atomic_thread_fence(::std::memory_order_acquire);
+            auto after = lock.load(::std::memory_order_relaxed);
+            if (unlikely(Detail::locked(before) || before != after || Detail::version(before) > rv)) {
+                if (t)
+                    Detail::abort(region, t);
+                else
+                    region->leave(Detail::ro_slot(tx)); // The transaction ends here
+                return false;
+            }
+            if (t) {
+                try {
+                    t->rset.push_back(&lock);
+                } catch (...) {
+                    Detail::abort(region, t);
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+    return read(shared, tx, static_cast<void const*>(source), sizeof(Type), static_cast<void*>(&target));
+}
+
+/** [thread-safe] Write operation of one value in the given transaction.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param source Source value (in a private region)
+ * @param target Target value (in the shared region), aligned on the alignment of the region
+ * @return Whether the whole transaction can continue
+**/
+template<class Type> inline bool write(shared_t shared, tx_t tx, Type const& source, Type* target) noexcept {
+    if constexpr (Detail::is_word<Type>) {
+        auto region = static_cast<Detail::Region*>(shared);
+        if (likely(region->align == sizeof(Type))) { // One word: one store in the write set
+            auto addr = reinterpret_cast<uintptr_t>(target);
+            auto t = reinterpret_cast<Detail::Transaction*>(tx);
+            auto pos = t->find(addr);
+            try {
+                auto value = pos < t->wset.size() ? t->values.data() + pos * sizeof(Type) : t->insert(addr, &region->lock(addr), sizeof(Type));
+                ::std::memcpy(value, &source, sizeof(Type));
+            } catch (...) {
+                Detail::abort(region, t);
+                return false;
+            }
+            return true;
+        }
+    }
+    return write(shared, tx, static_cast<void const*>(&source), sizeof(Type), static_cast<void*>(target));
+}
+
+/** [thread-safe] Memory allocation in the given transaction.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param size   Allocation requested size (in bytes), must be a positive multiple of the alignment
+ * @param target Pointer in private memory receiving the address of the first byte of the newly allocated, aligned segment
+ * @return Whether the whole transaction can continue (success/nomem), or not (abort)
+**/
+inline Alloc alloc(shared_t shared, tx_t tx, size_t size, void** target) noexcept {
+    auto region = static_cast<Detail::Region const*>(shared);
+    auto t = reinterpret_cast<Detail::Transaction*>(tx);
+    auto segment = region->allocate(size);
+    if (unlikely(!segment))
+        return Alloc::nomem;
+    try {
+        t->allocs.push_back(segment);
+    } catch (...) {
+        ::std::free(segment);
+        return Alloc::nomem;
+    }
+    *target = region->memory(segment);
+    return Alloc::success;
+}
+
+/** [thread-safe] Memory freeing in the given transaction.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param target Address of the first byte of the previously allocated segment to deallocate
+ * @return Whether the whole transaction can continue
+**/
+inline bool free(shared_t shared, tx_t tx, void* target) noexcept {
+    auto region = static_cast<Detail::Region*>(shared);
+    auto t = reinterpret_cast<Detail::Transaction*>(tx);
+    try {
+        t->frees.push_back(region->segment(target));
+    } catch (...) {
+        Detail::abort(region, t);
+        return false;
+    }
+    // NOTE: A segment allocated by this very transaction is published then retired at commit (see 'end'), or freed on abort
+    return true;
+}
+
+}
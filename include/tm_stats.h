@@ -0,0 +1,40 @@
+/**
+ * @file   tm_stats.h
+ * @author [...]
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * Optional statistics interface of the transaction manager (C and C++).
+ *
+ * A library may export 'tm_stats' next to the functions of 'tm.h'/'tm.hpp'
+ * (to include first); the grading program resolves it if present. As with
+ * 'stat' and 'struct stat', the function and the structure share their name.
+**/
+
+#pragma once
+
+#include <stdint.h>
+
+// -------------------------------------------------------------------------- //
+
+struct tm_stats {
+    uint64_t commits;         // Committed transactions
+    uint64_t aborts_validate; // Aborts on a word at a version more recent than the read version (at read or commit-time validation)
+    uint64_t aborts_locked;   // Aborts on a word locked by another transaction
+    uint64_t aborts_alloc;    // Aborts on a failed allocation of the transaction manager's own buffers
+    uint64_t bytes_logged;    // Bytes buffered in write sets
+};
+
+// -------------------------------------------------------------------------- //
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+    void tm_stats(shared_t, struct tm_stats*); // Fill the counters of the calling thread, cumulated since its first transaction
+#if defined(__cplusplus)
+}
+#endif
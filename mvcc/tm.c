@@ -0,0 +1,1144 @@
+/**
+ * @file   tm.c
+ * @author [...]
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * Multi-version (MVCC) word-based transaction manager implementation.
+ *
+ * Read-write transactions behave as in the TL2-style engine (see 'template/'):
+ * versioned locks hashed by word address, a global version clock, buffered
+ * writes and commit-time validation. In addition, each committing writer pushes
+ * the values it overwrites on a version chain attached to the word's stripe.
+ *
+ * Every transaction announces its snapshot (the clock value at begin) in a
+ * slot. Read-only transactions read each range as it was at that snapshot, in
+ * place and then from the version chains for the words overwritten since. They
+ * hence never abort, and only wait for a writer that may have taken its write
+ * version before their snapshot and is still writing back (see 'tm_end').
+ *
+ * A version is needed as long as some read-only snapshot predates it. The
+ * writers of a stripe prune its chain down to the versions newer than the
+ * oldest read-only snapshot (plus the one a reader stops on), and committing
+ * writers also sweep PRUNE_SWEEP stripes of the lock table in turn, freeing the
+ * whole chain of any stripe last written before that snapshot. A chain hence
+ * outlives its usefulness by at most one sweep of the table, i.e. by
+ * 2^LOCK_TABLE_BITS / PRUNE_SWEEP commits. Freed versions go to a per-thread
+ * pool, where the next commits of the thread take theirs.
+ *
+ * Freed segments are retired with the write version of the transaction that
+ * freed them, and given back once no transaction, read-only or read-write, has
+ * a snapshot below that version (no transaction can reach them anymore).
+**/
+
+// Compile-time configuration
+#define LOCK_TABLE_BITS    20   // Log2 of the number of stripes (versioned lock + version chain) in the lock table
+#define SNAPSHOT_SLOT_BITS 8    // Log2 of the number of slots where transactions announce their snapshot
+#define PRUNE_SWEEP        16   // Number of stripes each committing writer sweeps for versions no snapshot can need anymore (see 'region_sweep')
+#define VERSION_POOL_MAX   4096 // Maximum number of free versions a thread keeps for its next commits
+#define RECLAIM_BATCH      64   // Number of retired segments from which a committing writer tries to give them back
+
+// Requested features
+#define _GNU_SOURCE
+#define _POSIX_C_SOURCE   200809L
+#ifdef __STDC_NO_ATOMICS__
+    #error Current C11 compiler does not support atomic operations
+#endif
+
+// External headers
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Internal headers
+#include <tm.h>
+
+// -------------------------------------------------------------------------- //
+
+/** Define a proposition as likely true.
+ * @param prop Proposition
+**/
+#undef likely
+#ifdef __GNUC__
+    #define likely(prop) \
+        __builtin_expect((prop) ? 1 : 0, 1)
+#else
+    #define likely(prop) \
+        (prop)
+#endif
+
+/** Define a proposition as likely false.
+ * @param prop Proposition
+**/
+#undef unlikely
+#ifdef __GNUC__
+    #define unlikely(prop) \
+        __builtin_expect((prop) ? 1 : 0, 0)
+#else
+    #define unlikely(prop) \
+        (prop)
+#endif
+
+/** Define one or several attributes.
+ * @param type... Attribute names
+**/
+#undef as
+#ifdef __GNUC__
+    #define as(type...) \
+        __attribute__((type))
+#else
+    #define as(type...)
+    #warning This compiler has no support for GCC attributes
+#endif
+
+// -------------------------------------------------------------------------- //
+
+struct link {
+    struct link* prev; // Previous link in the chain
+    struct link* next; // Next link in the chain
+};
+
+/** Link reset.
+ * @param link Link to reset
+**/
+static void link_reset(struct link* link) {
+    link->prev = link;
+    link->next = link;
+}
+
+/** Link insertion before a "base" link.
+ * @param link Link to insert
+ * @param base Base link relative to which 'link' will be inserted
+**/
+static void link_insert(struct link* link, struct link* base) {
+    struct link* prev = base->prev;
+    link->prev = prev;
+    link->next = base;
+    base->prev = link;
+    prev->next = link;
+}
+
+/** Link removal.
+ * @param link Link to remove
+**/
+static void link_remove(struct link* link) {
+    struct link* prev = link->prev;
+    struct link* next = link->next;
+    prev->next = next;
+    next->prev = prev;
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Make sure a growable array can hold at least the given number of elements.
+ * @param data Pointer to the array base address
+ * @param cap  Pointer to the array capacity (in elements)
+ * @param need Required capacity (in elements)
+ * @param elem Size of one element (in bytes)
+ * @return Whether the operation is a success
+**/
+static bool array_reserve(void** data, size_t* cap, size_t need, size_t elem) {
+    if (likely(need <= *cap))
+        return true;
+    size_t ncap = *cap > 0 ? *cap : 16;
+    while (ncap < need)
+        ncap *= 2;
+    void* ndata = realloc(*data, ncap * elem);
+    if (unlikely(!ndata))
+        return false;
+    *data = ndata;
+    *cap  = ncap;
+    return true;
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Versioned lock word: version in the upper bits, lock bit in the LSB.
+**/
+typedef uint_fast64_t vword_t;
+typedef atomic_uint_fast64_t vlock_t;
+
+/** Check whether a versioned lock word is locked.
+ * @param word Versioned lock word
+ * @return Whether the word is locked
+**/
+static inline bool vword_locked(vword_t word) {
+    return (word & 1) != 0;
+}
+
+/** Get the version of a versioned lock word.
+ * @param word Versioned lock word
+ * @return Version
+**/
+static inline uint_fast64_t vword_version(vword_t word) {
+    return word >> 1;
+}
+
+/** Build an unlocked versioned lock word.
+ * @param version Version
+ * @return Versioned lock word
+**/
+static inline vword_t vword_make(uint_fast64_t version) {
+    return version << 1;
+}
+
+// -------------------------------------------------------------------------- //
+
+struct version {
+    struct version* next; // Older version of the same stripe
+    uintptr_t addr;       // Address of the overwritten word
+    uint_fast64_t ts;     // Version of the commit that overwrote the word
+    char value[];         // Overwritten value (one word)
+};
+
+struct stripe {
+    vlock_t lock;                  // Versioned lock
+    _Atomic(struct version*) head; // Version chain, newest first
+};
+
+struct snapshot_slot {
+    _Alignas(64) atomic_uint_fast64_t word; // Snapshot announced by the running transaction (see 'snapshot_word'), 'SNAPSHOT_FREE' if none
+};
+
+/** Snapshot slot value when no transaction uses it.
+**/
+#define SNAPSHOT_FREE UINT_FAST64_MAX
+
+/** Build the word announcing a snapshot in a slot.
+ * @param rv Snapshot (i.e. read version)
+ * @param rw Whether the transaction is read-write (it reads no version chain, but may still reach freed segments)
+ * @return Slot word
+**/
+static inline uint_fast64_t snapshot_word(uint_fast64_t rv, bool rw) {
+    return (rv << 1) | (rw ? 1 : 0);
+}
+
+// -------------------------------------------------------------------------- //
+
+struct segment {
+    struct link link;    // Chain of segments of the same state
+    size_t size;         // Usable size of the segment (in bytes)
+    uint_fast64_t stamp; // Write version of the transaction that freed the segment, once retired
+};
+
+struct region {
+    atomic_uint_fast64_t clock; // Global version clock
+    struct stripe* stripes; // Lock table
+    struct snapshot_slot* slots; // Snapshot slots
+    size_t word_shift;      // Log2 of the alignment, to map an address to its word index
+    void* start;            // Start of the shared memory region
+    size_t size;            // Size of the shared memory region (in bytes)
+    size_t align;           // Claimed alignment of the shared memory region (in bytes)
+    size_t align_alloc;     // Actual alignment of the memory allocations (in bytes)
+    size_t delta_alloc;     // Space to add at the beginning of the segment for its header (in bytes)
+    pthread_mutex_t alloc_lock; // Protect the segment chains
+    struct link allocs;     // Allocated (and published) segments
+    struct link retired;    // Freed segments, by (roughly) increasing stamp, until no transaction can reach them
+    size_t nbretired;       // Number of segments in 'retired'
+    atomic_size_t nbslots;  // Number of snapshot slots ever used
+    atomic_size_t sweep;    // Index of the next stripe to sweep (see 'region_sweep')
+};
+
+struct wentry {
+    uintptr_t addr; // Target word address (in shared memory)
+    vlock_t*  lock; // Associated versioned lock
+};
+
+struct acquired {
+    vlock_t* lock; // Acquired versioned lock
+    vword_t  word; // Versioned lock word before acquisition
+};
+
+struct transaction {
+    uint_fast64_t rv; // Read version, i.e. clock value at begin
+    size_t slot;      // Snapshot slot where the read version is announced
+    bool busy;        // Whether the descriptor is in use (see 'tx_acquire')
+    struct {
+        vlock_t** data; // Versioned locks of the read words
+        size_t size;
+        size_t cap;
+    } rset;
+    struct {
+        struct wentry* data; // Written words
+        char* values;        // Buffered values, one word per entry
+        size_t size;
+        size_t cap;
+        size_t vcap;         // Capacity of 'values' (in bytes)
+        uintptr_t lo;        // Lowest written address, 'UINTPTR_MAX' if none
+        uintptr_t hi;        // End of the highest written word, 0 if none
+    } wset;
+    struct {
+        struct acquired* data; // Locks held during commit
+        size_t size;
+        size_t cap;
+    } held;
+    struct {
+        struct segment** data; // Segments allocated by this transaction
+        size_t size;
+        size_t cap;
+    } allocs;
+    struct {
+        struct segment** data; // Segments freed by this transaction
+        size_t size;
+        size_t cap;
+    } frees;
+    struct {
+        struct version* head; // Free versions, chained through 'next'
+        size_t size;          // Number of free versions
+        size_t align;         // Value size of the free versions (in bytes)
+    } pool;
+};
+
+/** Check whether a transaction handle designates a read-only transaction.
+ * @param tx Transaction handle
+ * @return Whether the transaction is read-only
+**/
+static inline bool tx_is_ro(tx_t tx) {
+    return (tx & 1) != 0; // Descriptors are at least 2-byte aligned
+}
+
+/** Build the handle of a read-only transaction.
+ * @param rv   Read version
+ * @param slot Snapshot slot used
+ * @return Transaction handle
+**/
+static inline tx_t tx_make_ro(uint_fast64_t rv, size_t slot) {
+    return (tx_t) ((((rv << SNAPSHOT_SLOT_BITS) | slot) << 1) | 1);
+}
+
+/** Get the read version of a read-only transaction.
+ * @param tx Transaction handle
+ * @return Read version
+**/
+static inline uint_fast64_t tx_ro_rv(tx_t tx) {
+    return (uint_fast64_t) (tx >> (SNAPSHOT_SLOT_BITS + 1));
+}
+
+/** Get the snapshot slot of a read-only transaction.
+ * @param tx Transaction handle
+ * @return Snapshot slot
+**/
+static inline size_t tx_ro_slot(tx_t tx) {
+    return (size_t) ((tx >> 1) & ((1ul << SNAPSHOT_SLOT_BITS) - 1));
+}
+
+/** Get the stripe of a given word.
+ * @param region Shared memory region
+ * @param addr   Word address
+ * @return Associated stripe
+**/
+static inline struct stripe* region_stripe(struct region const* region, uintptr_t addr) {
+    return region->stripes + ((addr >> region->word_shift) & ((1ul << LOCK_TABLE_BITS) - 1));
+}
+
+/** Get the stripe of the word following the one of a given stripe.
+ * @param region Shared memory region
+ * @param stripe Stripe of a word
+ * @return Stripe of the next word
+**/
+static inline struct stripe* region_stripe_next(struct region const* region, struct stripe* stripe) {
+    ++stripe;
+    return likely(stripe != region->stripes + (1ul << LOCK_TABLE_BITS)) ? stripe : region->stripes;
+}
+
+/** Get the versioned lock protecting a given word.
+ * @param region Shared memory region
+ * @param addr   Word address
+ * @return Associated versioned lock
+**/
+static inline vlock_t* region_lock(struct region const* region, uintptr_t addr) {
+    return &(region_stripe(region, addr)->lock);
+}
+
+/** Get the segment header of a segment start address.
+ * @param region Shared memory region
+ * @param addr   Segment start address
+ * @return Segment header
+**/
+static inline struct segment* region_segment(struct region const* region, void* addr) {
+    return (struct segment*) ((uintptr_t) addr - region->delta_alloc);
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Announce a new snapshot in a free slot.
+ * @param region Shared memory region
+ * @param rw     Whether the transaction is read-write
+ * @param rv     Snapshot taken (i.e. read version)
+ * @return Slot used, to release at the end of the transaction
+**/
+static size_t snapshot_acquire(struct region* region, bool rw, uint_fast64_t* rv) {
+    static atomic_size_t next_hint = 0;
+    static _Thread_local size_t hint = SIZE_MAX;
+    if (unlikely(hint == SIZE_MAX))
+        hint = atomic_fetch_add_explicit(&next_hint, 1, memory_order_relaxed);
+    size_t const nbslots = 1ul << SNAPSHOT_SLOT_BITS;
+    size_t slot = hint % nbslots;
+    uint_fast64_t version = atomic_load(&(region->clock));
+    while (true) { // Claim a free slot
+        uint_fast64_t expected = SNAPSHOT_FREE;
+        if (likely(atomic_compare_exchange_weak(&(region->slots[slot].word), &expected, snapshot_word(version, rw))))
+            break;
+        slot = (slot + 1) % nbslots;
+        if (slot == hint % nbslots)
+            sched_yield();
+    }
+    size_t used = atomic_load_explicit(&(region->nbslots), memory_order_relaxed);
+    while (used <= slot && !atomic_compare_exchange_weak(&(region->nbslots), &used, slot + 1));
+    while (true) { // Make sure the announced snapshot is visible to any pruning or reclaiming writer (see 'snapshot_oldest')
+        uint_fast64_t current = atomic_load(&(region->clock));
+        if (likely(current == version))
+            break;
+        version = current;
+        atomic_store(&(region->slots[slot].word), snapshot_word(version, rw));
+    }
+    *rv = version;
+    return slot;
+}
+
+/** Release a snapshot slot.
+ * @param region Shared memory region
+ * @param slot   Slot to release
+**/
+static void snapshot_release(struct region* region, size_t slot) {
+    atomic_store_explicit(&(region->slots[slot].word), SNAPSHOT_FREE, memory_order_release);
+}
+
+/** Get the oldest snapshot any transaction may use, now or in the future.
+ * @param region Shared memory region
+ * @param rw     Whether to also account for read-write transactions (to reclaim segments), or only for read-only ones (to prune versions)
+ * @return Oldest snapshot
+**/
+static uint_fast64_t snapshot_oldest(struct region* region, bool rw) {
+    uint_fast64_t oldest = atomic_load(&(region->clock)); // A snapshot announced after the scan below is at least this version
+    size_t nbslots = atomic_load(&(region->nbslots));
+    for (size_t i = 0; i < nbslots; ++i) {
+        uint_fast64_t word = atomic_load(&(region->slots[i].word));
+        if (word == SNAPSHOT_FREE || ((word & 1) != 0 && !rw))
+            continue;
+        if ((word >> 1) < oldest)
+            oldest = word >> 1;
+    }
+    return oldest;
+}
+
+/** Read a range of words as it was at the given snapshot.
+ * @param region Shared memory region
+ * @param addr   Start address of the range
+ * @param size   Length of the range (in bytes)
+ * @param rv     Snapshot (i.e. read version)
+ * @param target Target start address (in a private region)
+**/
+static void snapshot_read(struct region const* region, uintptr_t addr, size_t size, uint_fast64_t rv, void* target) {
+    size_t align = region->align;
+    struct stripe* first = region_stripe(region, addr);
+    // Wait for the writers that may have taken their write version before the snapshot, the only ones writing back values of the snapshot
+    struct stripe* stripe = first;
+    for (size_t offset = 0; offset < size; offset += align, stripe = region_stripe_next(region, stripe)) {
+        while (true) {
+            vword_t word = atomic_load_explicit(&(stripe->lock), memory_order_acquire);
+            if (likely(!vword_locked(word) || vword_version(word) > rv)) // Unlocked, or stamped by (or locked after) a commit after the snapshot
+                break;
+            sched_yield();
+        }
+    }
+    memcpy(target, (void const*) addr, size);
+    atomic_thread_fence(memory_order_acquire);
+    // Restore the words overwritten since the snapshot, whose stripe then has a more recent version (a writer pushes the version before writing back)
+    stripe = first;
+    for (size_t offset = 0; offset < size; offset += align, stripe = region_stripe_next(region, stripe)) {
+        if (likely(vword_version(atomic_load_explicit(&(stripe->lock), memory_order_relaxed)) <= rv))
+            continue;
+        struct version const* found = NULL;
+        for (struct version const* version = atomic_load_explicit(&(stripe->head), memory_order_acquire); version && version->ts > rv; version = version->next) {
+            if (version->addr == addr + offset)
+                found = version;
+        }
+        if (found)
+            memcpy((char*) target + offset, found->value, align);
+    }
+}
+
+// -------------------------------------------------------------------------- //
+
+static pthread_key_t tx_home_key; // Frees the home descriptor of an exiting thread
+static bool tx_home_keyed = false; // Whether 'tx_home_key' could be created
+static _Thread_local struct transaction* tx_home = NULL; // Descriptor (buffers and version pool) reused by every read-write transaction of the thread
+
+/** Free a transaction descriptor, its buffers and its version pool.
+ * @param tx Transaction descriptor to free
+**/
+static void tx_destroy(void* tx) {
+    struct transaction* t = (struct transaction*) tx;
+    free(t->rset.data);
+    free(t->wset.data);
+    free(t->wset.values);
+    free(t->held.data);
+    free(t->allocs.data);
+    free(t->frees.data);
+    while (t->pool.head) {
+        struct version* next = t->pool.head->next;
+        free(t->pool.head);
+        t->pool.head = next;
+    }
+    free(t);
+}
+
+/** Create the key freeing the home descriptors at thread exit.
+**/
+static void as(constructor) tx_home_setup(void) {
+    tx_home_keyed = pthread_key_create(&tx_home_key, tx_destroy) == 0;
+}
+
+/** Delete the key freeing the home descriptors, and free the one of the unloading thread.
+**/
+static void as(destructor) tx_home_teardown(void) {
+    if (tx_home_keyed)
+        pthread_key_delete(tx_home_key);
+    if (tx_home) {
+        tx_destroy(tx_home);
+        tx_home = NULL;
+    }
+}
+
+/** Get a transaction descriptor, without heap allocation in steady state.
+ * @return Transaction descriptor with empty sets, NULL on failure
+**/
+static struct transaction* tx_acquire(void) {
+    struct transaction* tx = tx_home;
+    if (likely(tx && !tx->busy)) {
+        tx->busy = true;
+        return tx;
+    }
+    tx = (struct transaction*) calloc(1, sizeof(struct transaction));
+    if (unlikely(!tx))
+        return NULL;
+    tx->wset.lo = UINTPTR_MAX;
+    if (!tx_home && tx_home_keyed && pthread_setspecific(tx_home_key, tx) == 0) // First transaction of the thread
+        tx_home = tx;
+    tx->busy = true;
+    return tx;
+}
+
+/** Release a transaction descriptor and its snapshot slot, keeping its buffers for the next transaction of the thread.
+ * @param region Shared memory region
+ * @param tx     Transaction to release
+**/
+static void tx_release(struct region* region, struct transaction* tx) {
+    snapshot_release(region, tx->slot);
+    if (unlikely(tx != tx_home)) { // Concurrent transactions in the same thread
+        tx_destroy(tx);
+        return;
+    }
+    tx->rset.size   = 0;
+    tx->wset.size   = 0;
+    tx->wset.lo     = UINTPTR_MAX;
+    tx->wset.hi     = 0;
+    tx->held.size   = 0;
+    tx->allocs.size = 0;
+    tx->frees.size  = 0;
+    tx->busy = false;
+}
+
+/** Release the locks held by a transaction, restoring their previous word.
+ * @param tx Transaction holding the locks
+**/
+static void tx_unlock(struct transaction* tx) {
+    for (size_t i = 0; i < tx->held.size; ++i)
+        atomic_store_explicit(tx->held.data[i].lock, tx->held.data[i].word, memory_order_release);
+    tx->held.size = 0;
+}
+
+/** Abort a transaction, undoing its speculative allocations and releasing it.
+ * @param region Shared memory region
+ * @param tx     Transaction to abort
+**/
+static void tx_abort(struct region* region, struct transaction* tx) {
+    tx_unlock(tx);
+    for (size_t i = 0; i < tx->allocs.size; ++i)
+        free(tx->allocs.data[i]);
+    tx_release(region, tx);
+}
+
+/** Give a version no snapshot can need anymore to the pool of a transaction, or back to the C library if the pool is full.
+ * @param tx      Transaction
+ * @param version Version to free
+**/
+static void tx_pool_put(struct transaction* tx, struct version* version) {
+    if (unlikely(tx->pool.size >= VERSION_POOL_MAX)) {
+        free(version);
+        return;
+    }
+    version->next = tx->pool.head;
+    tx->pool.head = version;
+    ++(tx->pool.size);
+}
+
+/** Make sure the pool of a transaction holds at least the given number of versions.
+ * @param tx    Transaction
+ * @param align Value size of the versions (in bytes)
+ * @param need  Number of versions required
+ * @return Whether the operation is a success
+**/
+static bool tx_pool_fill(struct transaction* tx, size_t align, size_t need) {
+    if (unlikely(tx->pool.align != align)) { // First commit of the thread, or on a region of another alignment
+        while (tx->pool.head) {
+            struct version* next = tx->pool.head->next;
+            free(tx->pool.head);
+            tx->pool.head = next;
+        }
+        tx->pool.size  = 0;
+        tx->pool.align = align;
+    }
+    while (tx->pool.size < need) {
+        struct version* version = (struct version*) malloc(sizeof(struct version) + align);
+        if (unlikely(!version))
+            return false;
+        version->next = tx->pool.head;
+        tx->pool.head = version;
+        ++(tx->pool.size);
+    }
+    return true;
+}
+
+/** Take a version from the pool of a transaction, filled beforehand (see 'tx_pool_fill').
+ * @param tx Transaction
+ * @return Version
+**/
+static inline struct version* tx_pool_take(struct transaction* tx) {
+    struct version* version = tx->pool.head;
+    tx->pool.head = version->next;
+    --(tx->pool.size);
+    return version;
+}
+
+/** Free the versions of a stripe that no snapshot, current or future, can need, the stripe being locked by the caller.
+ * @param stripe Stripe to prune
+ * @param oldest Oldest read-only snapshot (see 'snapshot_oldest')
+ * @param tx     Transaction whose pool receives the freed versions
+**/
+static void stripe_prune(struct stripe* stripe, uint_fast64_t oldest, struct transaction* tx) {
+    struct version* version = atomic_load_explicit(&(stripe->head), memory_order_relaxed);
+    while (version && version->ts > oldest)
+        version = version->next;
+    if (!version) // Nothing to prune
+        return;
+    struct version* stale = version->next; // A reader stops at 'version' (or before) and never follows this pointer
+    version->next = NULL;
+    while (stale) {
+        struct version* next = stale->next;
+        tx_pool_put(tx, stale);
+        stale = next;
+    }
+}
+
+/** Publish the segments allocated by a committing transaction and retire the ones it freed.
+ * @param region Shared memory region
+ * @param tx     Committing transaction
+ * @param wv     Write version of the transaction
+ * @return Whether enough segments are retired to try giving them back (see 'region_reclaim')
+**/
+static bool tx_publish(struct region* region, struct transaction* tx, uint_fast64_t wv) {
+    if (tx->allocs.size == 0 && tx->frees.size == 0)
+        return false;
+    pthread_mutex_lock(&(region->alloc_lock));
+    for (size_t i = 0; i < tx->allocs.size; ++i)
+        link_insert(&(tx->allocs.data[i]->link), &(region->allocs));
+    for (size_t i = 0; i < tx->frees.size; ++i) {
+        tx->frees.data[i]->stamp = wv;
+        link_remove(&(tx->frees.data[i]->link));
+        link_insert(&(tx->frees.data[i]->link), &(region->retired));
+    }
+    region->nbretired += tx->frees.size;
+    bool reclaim = region->nbretired >= RECLAIM_BATCH;
+    pthread_mutex_unlock(&(region->alloc_lock));
+    return reclaim;
+}
+
+/** Give back the retired segments no transaction can reach anymore.
+ * @param region Shared memory region
+**/
+static void region_reclaim(struct region* region) {
+    uint_fast64_t oldest = snapshot_oldest(region, true);
+    struct link stale;
+    link_reset(&stale);
+    pthread_mutex_lock(&(region->alloc_lock));
+    while (true) { // Stop at the first segment still reachable, the ones after it were (mostly) freed later
+        struct link* link = region->retired.next;
+        if (link == &(region->retired) || ((struct segment*) link)->stamp > oldest)
+            break;
+        link_remove(link);
+        link_insert(link, &stale);
+        --(region->nbretired);
+    }
+    pthread_mutex_unlock(&(region->alloc_lock));
+    while (stale.next != &stale) {
+        struct link* link = stale.next;
+        link_remove(link);
+        free(link);
+    }
+}
+
+/** Prune the version chains of the next stripes of the lock table, so that the stripes no longer written do not keep theirs.
+ * @param region Shared memory region
+ * @param tx     Committing transaction, whose pool receives the freed versions
+ * @param oldest Oldest read-only snapshot (see 'snapshot_oldest')
+**/
+static void region_sweep(struct region* region, struct transaction* tx, uint_fast64_t oldest) {
+    size_t start = atomic_fetch_add_explicit(&(region->sweep), PRUNE_SWEEP, memory_order_relaxed);
+    for (size_t i = 0; i < PRUNE_SWEEP; ++i) {
+        struct stripe* stripe = region->stripes + ((start + i) & ((1ul << LOCK_TABLE_BITS) - 1));
+        if (likely(!atomic_load_explicit(&(stripe->head), memory_order_relaxed)))
+            continue;
+        vword_t word = atomic_load_explicit(&(stripe->lock), memory_order_relaxed);
+        if (vword_locked(word) || !atomic_compare_exchange_strong_explicit(&(stripe->lock), &word, word | 1, memory_order_acquire, memory_order_relaxed))
+            continue; // Being written, its writer prunes it
+        if (vword_version(word) <= oldest) { // Versions only ever increase, so no read-only transaction reads this chain (see 'snapshot_read')
+            struct version* version = atomic_load_explicit(&(stripe->head), memory_order_relaxed);
+            atomic_store_explicit(&(stripe->head), NULL, memory_order_relaxed);
+            while (version) {
+                struct version* next = version->next;
+                tx_pool_put(tx, version);
+                version = next;
+            }
+        } else {
+            stripe_prune(stripe, oldest, tx);
+        }
+        atomic_store_explicit(&(stripe->lock), word, memory_order_release);
+    }
+}
+
+/** Find the versioned lock word held by the transaction before it acquired it.
+ * @param tx   Transaction
+ * @param lock Versioned lock to look up
+ * @return Pointer to the word before acquisition, NULL if not held by the transaction
+**/
+static vword_t const* tx_held(struct transaction const* tx, vlock_t const* lock) {
+    for (size_t i = 0; i < tx->held.size; ++i) {
+        if (tx->held.data[i].lock == lock)
+            return &(tx->held.data[i].word);
+    }
+    return NULL;
+}
+
+/** Find the write set entry of a given word.
+ * @param tx   Transaction
+ * @param addr Word address
+ * @return Index of the entry, 'tx->wset.size' if not found
+**/
+static size_t tx_wset_find(struct transaction const* tx, uintptr_t addr) {
+    for (size_t i = tx->wset.size; i > 0; --i) {
+        if (tx->wset.data[i - 1].addr == addr)
+            return i - 1;
+    }
+    return tx->wset.size;
+}
+
+/** Check whether a range may overlap a word of the write set.
+ * @param tx   Transaction
+ * @param addr Start address of the range
+ * @param size Length of the range (in bytes)
+ * @return Whether the range is within the bounds of the written words
+**/
+static inline bool tx_wset_overlaps(struct transaction const* tx, uintptr_t addr, size_t size) {
+    return addr < tx->wset.hi && addr + size > tx->wset.lo;
+}
+
+/** Acquire a versioned lock for the commit of a transaction.
+ * @param tx   Committing transaction
+ * @param lock Versioned lock to acquire
+ * @return Whether the lock is now held by the transaction
+**/
+static bool tx_lock(struct transaction* tx, vlock_t* lock) {
+    vword_t word = atomic_load_explicit(lock, memory_order_relaxed);
+    if (vword_locked(word))
+        return tx_held(tx, lock) != NULL;
+    if (unlikely(!atomic_compare_exchange_strong_explicit(lock, &word, word | 1, memory_order_acquire, memory_order_relaxed)))
+        return false;
+    tx->held.data[tx->held.size++] = (struct acquired){ .lock = lock, .word = word };
+    return true;
+}
+
+/** Validate the read set of a committing transaction.
+ * @param tx Transaction to validate
+ * @return Whether every read word is still at a version no greater than the read version
+**/
+static bool tx_validate(struct transaction const* tx) {
+    for (size_t i = 0; i < tx->rset.size; ++i) {
+        vword_t word = atomic_load_explicit(tx->rset.data[i], memory_order_acquire);
+        if (vword_locked(word)) {
+            vword_t const* held = tx_held(tx, tx->rset.data[i]);
+            if (!held)
+                return false;
+            word = *held;
+        }
+        if (vword_version(word) > tx->rv)
+            return false;
+    }
+    return true;
+}
+
+/** Read a range of words none of which is in the write set, logging their versioned locks (reserved by the caller).
+ * @param region Shared memory region
+ * @param tx     Transaction
+ * @param addr   Start address of the range
+ * @param size   Length of the range (in bytes)
+ * @param target Target start address (in a private region)
+ * @return Whether every word is consistent with the read version
+**/
+static bool tx_read(struct region const* region, struct transaction* tx, uintptr_t addr, size_t size, void* target) {
+    size_t align = region->align;
+    struct stripe* first = region_stripe(region, addr);
+    struct stripe* stripe = first;
+    for (size_t offset = 0; offset < size; offset += align, stripe = region_stripe_next(region, stripe)) {
+        vword_t word = atomic_load_explicit(&(stripe->lock), memory_order_acquire);
+        if (unlikely(vword_locked(word) || vword_version(word) > tx->rv))
+            return false;
+    }
+    memcpy(target, (void const*) addr, size);
+    atomic_thread_fence(memory_order_acquire);
+    stripe = first;
+    for (size_t offset = 0; offset < size; offset += align, stripe = region_stripe_next(region, stripe)) { // A writer that changed a word in between still holds its lock, or released it at a more recent version
+        vword_t word = atomic_load_explicit(&(stripe->lock), memory_order_relaxed);
+        if (unlikely(vword_locked(word) || vword_version(word) > tx->rv))
+            return false;
+        tx->rset.data[tx->rset.size++] = &(stripe->lock);
+    }
+    return true;
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Create (i.e. allocate + init) a new shared memory region, with one first non-free-able allocated segment of the requested size and alignment.
+ * @param size  Size of the first shared segment of memory to allocate (in bytes), must be a positive multiple of the alignment
+ * @param align Alignment (in bytes, must be a power of 2) that the shared memory region must support
+ * @return Opaque shared memory region handle, 'invalid_shared' on failure
+**/
+shared_t tm_create(size_t size, size_t align) {
+    struct region* region = (struct region*) malloc(sizeof(struct region));
+    if (unlikely(!region))
+        return invalid_shared;
+    size_t align_alloc = align < sizeof(void*) ? sizeof(void*) : align; // Also satisfy alignment requirement of 'struct segment'
+    if (unlikely(posix_memalign(&(region->start), align_alloc, size) != 0)) {
+        free(region);
+        return invalid_shared;
+    }
+    region->stripes = (struct stripe*) calloc(1ul << LOCK_TABLE_BITS, sizeof(struct stripe));
+    if (unlikely(!region->stripes)) {
+        free(region->start);
+        free(region);
+        return invalid_shared;
+    }
+    region->slots = (struct snapshot_slot*) aligned_alloc(sizeof(struct snapshot_slot), sizeof(struct snapshot_slot) << SNAPSHOT_SLOT_BITS);
+    if (unlikely(!region->slots)) {
+        free(region->stripes);
+        free(region->start);
+        free(region);
+        return invalid_shared;
+    }
+    if (unlikely(pthread_mutex_init(&(region->alloc_lock), NULL) != 0)) {
+        free(region->slots);
+        free(region->stripes);
+        free(region->start);
+        free(region);
+        return invalid_shared;
+    }
+    atomic_init(&(region->nbslots), 0);
+    atomic_init(&(region->sweep), 0);
+    for (size_t i = 0; i < (1ul << SNAPSHOT_SLOT_BITS); ++i)
+        atomic_init(&(region->slots[i].word), SNAPSHOT_FREE);
+    memset(region->start, 0, size);
+    atomic_init(&(region->clock), 0);
+    link_reset(&(region->allocs));
+    link_reset(&(region->retired));
+    region->nbretired   = 0;
+    region->word_shift  = __builtin_ctzl(align);
+    region->size        = size;
+    region->align       = align;
+    region->align_alloc = align_alloc;
+    region->delta_alloc = (sizeof(struct segment) + align_alloc - 1) / align_alloc * align_alloc;
+    return region;
+}
+
+/** Destroy (i.e. clean-up + free) a given shared memory region.
+ * @param shared Shared memory region to destroy, with no running transaction
+**/
+void tm_destroy(shared_t shared) {
+    struct region* region = (struct region*) shared;
+    struct link* chains[] = { &(region->allocs), &(region->retired) };
+    for (size_t i = 0; i < sizeof(chains) / sizeof(*chains); ++i) {
+        while (true) { // Free segments of the chain
+            struct link* link = chains[i]->next;
+            if (link == chains[i])
+                break;
+            link_remove(link);
+            free(link);
+        }
+    }
+    for (size_t i = 0; i < (1ul << LOCK_TABLE_BITS); ++i) { // Free version chains
+        struct version* version = atomic_load_explicit(&(region->stripes[i].head), memory_order_relaxed);
+        while (version) {
+            struct version* next = version->next;
+            free(version);
+            version = next;
+        }
+    }
+    pthread_mutex_destroy(&(region->alloc_lock));
+    free(region->slots);
+    free(region->stripes);
+    free(region->start);
+    free(region);
+}
+
+/** [thread-safe] Return the start address of the first allocated segment in the shared memory region.
+ * @param shared Shared memory region to query
+ * @return Start address of the first allocated segment
+**/
+void* tm_start(shared_t shared) {
+    return ((struct region*) shared)->start;
+}
+
+/** [thread-safe] Return the size (in bytes) of the first allocated segment of the shared memory region.
+ * @param shared Shared memory region to query
+ * @return First allocated segment size
+**/
+size_t tm_size(shared_t shared) {
+    return ((struct region*) shared)->size;
+}
+
+/** [thread-safe] Return the alignment (in bytes) of the memory accesses on the given shared memory region.
+ * @param shared Shared memory region to query
+ * @return Alignment used globally
+**/
+size_t tm_align(shared_t shared) {
+    return ((struct region*) shared)->align;
+}
+
+/** [thread-safe] Begin a new transaction on the given shared memory region.
+ * @param shared Shared memory region to start a transaction on
+ * @param is_ro  Whether the transaction is read-only
+ * @return Opaque transaction ID, 'invalid_tx' on failure
+**/
+tx_t tm_begin(shared_t shared, bool is_ro) {
+    struct region* region = (struct region*) shared;
+    if (is_ro) {
+        uint_fast64_t rv;
+        size_t slot = snapshot_acquire(region, false, &rv);
+        return tx_make_ro(rv, slot);
+    }
+    struct transaction* tx = tx_acquire();
+    if (unlikely(!tx))
+        return invalid_tx;
+    tx->slot = snapshot_acquire(region, true, &(tx->rv));
+    return (tx_t) tx;
+}
+
+/** [thread-safe] End the given transaction.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to end
+ * @return Whether the whole transaction committed
+**/
+bool tm_end(shared_t shared, tx_t tx) {
+    struct region* region = (struct region*) shared;
+    if (tx_is_ro(tx)) { // Every read was served from the snapshot
+        snapshot_release(region, tx_ro_slot(tx));
+        return true;
+    }
+    struct transaction* t = (struct transaction*) tx;
+    if (t->wset.size == 0 && t->frees.size == 0) { // Every read was consistent with the read version
+        tx_publish(region, t, 0); // Allocated segments only, unreachable from the shared memory
+        tx_release(region, t);
+        return true;
+    }
+    // Make sure the pool holds the versions that will keep the overwritten values
+    if (unlikely(!tx_pool_fill(t, region->align, t->wset.size))) {
+        tx_abort(region, t);
+        return false;
+    }
+    // Lock the write set (and the freed segments, so that concurrent readers notice)
+    size_t nblocks = t->wset.size;
+    for (size_t i = 0; i < t->frees.size; ++i)
+        nblocks += t->frees.data[i]->size >> region->word_shift;
+    if (unlikely(!array_reserve((void**) &(t->held.data), &(t->held.cap), nblocks, sizeof(*(t->held.data))))) {
+        tx_abort(region, t);
+        return false;
+    }
+    for (size_t i = 0; i < t->wset.size; ++i) {
+        if (unlikely(!tx_lock(t, t->wset.data[i].lock))) {
+            tx_abort(region, t);
+            return false;
+        }
+    }
+    for (size_t i = 0; i < t->frees.size; ++i) {
+        uintptr_t addr = (uintptr_t) t->frees.data[i] + region->delta_alloc;
+        uintptr_t stop = addr + t->frees.data[i]->size;
+        for (; addr < stop; addr += region->align) {
+            if (unlikely(!tx_lock(t, region_lock(region, addr)))) {
+                tx_abort(region, t);
+                return false;
+            }
+        }
+    }
+    // Take the write version and stamp it on the held locks, so that a read-only transaction with an earlier snapshot no longer waits for this commit (see 'snapshot_read')
+    uint_fast64_t wv = atomic_fetch_add_explicit(&(region->clock), 1, memory_order_acq_rel) + 1;
+    vword_t word = vword_make(wv);
+    for (size_t i = 0; i < t->held.size; ++i)
+        atomic_store_explicit(t->held.data[i].lock, word | 1, memory_order_relaxed);
+    // Validate the read set if someone committed in between
+    if (wv != t->rv + 1 && unlikely(!tx_validate(t))) {
+        for (size_t i = 0; i < t->held.size; ++i) // The stamps may have been seen, keep the versions of the stripes increasing (see 'region_sweep')
+            t->held.data[i].word = word;
+        tx_abort(region, t);
+        return false;
+    }
+    // Save the overwritten values, then write back
+    uint_fast64_t oldest = snapshot_oldest(region, false);
+    for (size_t i = 0; i < t->wset.size; ++i) {
+        struct stripe* stripe = region_stripe(region, t->wset.data[i].addr);
+        struct version* version = tx_pool_take(t);
+        version->addr = t->wset.data[i].addr;
+        version->ts   = wv;
+        version->next = atomic_load_explicit(&(stripe->head), memory_order_relaxed);
+        memcpy(version->value, (void const*) version->addr, region->align);
+        atomic_store_explicit(&(stripe->head), version, memory_order_release);
+        stripe_prune(stripe, oldest, t);
+    }
+    atomic_thread_fence(memory_order_release); // A reader that sees a written back value also sees the version keeping the value it overwrote
+    for (size_t i = 0; i < t->wset.size; ++i)
+        memcpy((void*) t->wset.data[i].addr, t->wset.values + i * region->align, region->align);
+    // Publish allocated segments and retire freed ones before releasing the locks (a later transaction may free one of them)
+    bool reclaim = tx_publish(region, t, wv);
+    for (size_t i = 0; i < t->held.size; ++i)
+        atomic_store_explicit(t->held.data[i].lock, word, memory_order_release);
+    region_sweep(region, t, oldest);
+    tx_release(region, t);
+    if (unlikely(reclaim))
+        region_reclaim(region);
+    return true;
+}
+
+/** [thread-safe] Read operation in the given transaction, source in the shared region and target in a private region.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param source Source start address (in the shared region)
+ * @param size   Length to copy (in bytes), must be a positive multiple of the alignment
+ * @param target Target start address (in a private region)
+ * @return Whether the whole transaction can continue
+**/
+bool tm_read(shared_t shared, tx_t tx, void const* source, size_t size, void* target) {
+    struct region* region = (struct region*) shared;
+    if (tx_is_ro(tx)) { // Read from the snapshot, never aborts
+        snapshot_read(region, (uintptr_t) source, size, tx_ro_rv(tx), target);
+        return true;
+    }
+    struct transaction* t = (struct transaction*) tx;
+    size_t align = region->align;
+    if (unlikely(!array_reserve((void**) &(t->rset.data), &(t->rset.cap), t->rset.size + (size >> region->word_shift), sizeof(*(t->rset.data))))) {
+        tx_abort(region, t);
+        return false;
+    }
+    if (likely(!tx_wset_overlaps(t, (uintptr_t) source, size))) { // The whole range in one pass
+        if (unlikely(!tx_read(region, t, (uintptr_t) source, size, target))) {
+            tx_abort(region, t);
+            return false;
+        }
+        return true;
+    }
+    for (size_t offset = 0; offset < size; offset += align) {
+        uintptr_t addr = (uintptr_t) source + offset;
+        void* dst = (char*) target + offset;
+        size_t pos = tx_wset_find(t, addr);
+        if (pos < t->wset.size) { // Read-after-write
+            memcpy(dst, t->wset.values + pos * align, align);
+            continue;
+        }
+        if (unlikely(!tx_read(region, t, addr, align, dst))) {
+            tx_abort(region, t);
+            return false;
+        }
+    }
+    return true;
+}
+
+/** [thread-safe] Write operation in the given transaction, source in a private region and target in the shared region.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param source Source start address (in a private region)
+ * @param size   Length to copy (in bytes), must be a positive multiple of the alignment
+ * @param target Target start address (in the shared region)
+ * @return Whether the whole transaction can continue
+**/
+bool tm_write(shared_t shared, tx_t tx, void const* source, size_t size, void* target) {
+    struct region* region = (struct region*) shared;
+    struct transaction* t = (struct transaction*) tx;
+    size_t align = region->align;
+    size_t need  = t->wset.size + (size >> region->word_shift);
+    if (unlikely(!array_reserve((void**) &(t->wset.data), &(t->wset.cap), need, sizeof(*(t->wset.data)))
+              || !array_reserve((void**) &(t->wset.values), &(t->wset.vcap), need * align, 1))) {
+        tx_abort(region, t);
+        return false;
+    }
+    bool fresh = !tx_wset_overlaps(t, (uintptr_t) target, size); // No word of the range is in the write set yet
+    for (size_t offset = 0; offset < size; offset += align) {
+        uintptr_t addr = (uintptr_t) target + offset;
+        size_t pos = fresh ? t->wset.size : tx_wset_find(t, addr);
+        if (pos == t->wset.size) { // New entry
+            t->wset.data[pos] = (struct wentry){ .addr = addr, .lock = region_lock(region, addr) };
+            ++(t->wset.size);
+        }
+        memcpy(t->wset.values + pos * align, (char const*) source + offset, align);
+    }
+    if ((uintptr_t) target < t->wset.lo)
+        t->wset.lo = (uintptr_t) target;
+    if ((uintptr_t) target + size > t->wset.hi)
+        t->wset.hi = (uintptr_t) target + size;
+    return true;
+}
+
+/** [thread-safe] Memory allocation in the given transaction.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param size   Allocation requested size (in bytes), must be a positive multiple of the alignment
+ * @param target Pointer in private memory receiving the address of the first byte of the newly allocated, aligned segment
+ * @return Whether the whole transaction can continue (success/nomem), or not (abort_alloc)
+**/
+alloc_t tm_alloc(shared_t shared, tx_t tx, size_t size, void** target) {
+    struct region* region = (struct region*) shared;
+    struct transaction* t = (struct transaction*) tx;
+    if (unlikely(!array_reserve((void**) &(t->allocs.data), &(t->allocs.cap), t->allocs.size + 1, sizeof(*(t->allocs.data)))))
+        return nomem_alloc;
+    struct segment* segment;
+    if (unlikely(posix_memalign((void**) &segment, region->align_alloc, region->delta_alloc + size) != 0)) // Allocation failed
+        return nomem_alloc;
+    segment->size = size;
+    t->allocs.data[t->allocs.size++] = segment;
+    void* start = (void*) ((uintptr_t) segment + region->delta_alloc);
+    memset(start, 0, size);
+    *target = start;
+    return success_alloc;
+}
+
+/** [thread-safe] Memory freeing in the given transaction.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param target Address of the first byte of the previously allocated segment to deallocate
+ * @return Whether the whole transaction can continue
+**/
+bool tm_free(shared_t shared, tx_t tx, void* target) {
+    struct region* region = (struct region*) shared;
+    struct transaction* t = (struct transaction*) tx;
+    if (unlikely(!array_reserve((void**) &(t->frees.data), &(t->frees.cap), t->frees.size + 1, sizeof(*(t->frees.data))))) {
+        tx_abort(region, t);
+        return false;
+    }
+    // NOTE: A segment allocated by this very transaction is published then retired at commit (see 'tm_end'), or freed on abort
+    t->frees.data[t->frees.size++] = region_segment(region, target);
+    return true;
+}
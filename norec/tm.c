@@ -0,0 +1,764 @@
+/**
+ * @file   tm.c
+ * @author [...]
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * NOrec-style transaction manager implementation.
+ *
+ * There is no per-word metadata: a single global sequence lock (odd while a
+ * writer commits) orders the commits. Reads copy a whole range at once and log
+ * the values they observed, and whenever the sequence lock moved the read set is
+ * validated by value. Writes are buffered and replayed at commit, under the
+ * sequence lock. Only the words of a range within the bounds of the write set
+ * are looked up in it, one by one.
+ *
+ * Every transaction announces the sequence lock value its reads are consistent
+ * with in a slot. Freed segments are retired with the value the sequence lock
+ * takes when the transaction that freed them commits, and given back once no
+ * announced value is below it (no transaction can reach them anymore).
+**/
+
+// Compile-time configuration
+#define SNAPSHOT_SLOT_BITS 8  // Log2 of the number of slots where transactions announce their snapshot
+#define RECLAIM_BATCH      64 // Number of retired segments from which a committing writer tries to give them back
+
+// Requested features
+#define _GNU_SOURCE
+#define _POSIX_C_SOURCE   200809L
+#ifdef __STDC_NO_ATOMICS__
+    #error Current C11 compiler does not support atomic operations
+#endif
+
+// External headers
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Internal headers
+#include <tm.h>
+
+// -------------------------------------------------------------------------- //
+
+/** Define a proposition as likely true.
+ * @param prop Proposition
+**/
+#undef likely
+#ifdef __GNUC__
+    #define likely(prop) \
+        __builtin_expect((prop) ? 1 : 0, 1)
+#else
+    #define likely(prop) \
+        (prop)
+#endif
+
+/** Define a proposition as likely false.
+ * @param prop Proposition
+**/
+#undef unlikely
+#ifdef __GNUC__
+    #define unlikely(prop) \
+        __builtin_expect((prop) ? 1 : 0, 0)
+#else
+    #define unlikely(prop) \
+        (prop)
+#endif
+
+/** Define one or several attributes.
+ * @param type... Attribute names
+**/
+#undef as
+#ifdef __GNUC__
+    #define as(type...) \
+        __attribute__((type))
+#else
+    #define as(type...)
+    #warning This compiler has no support for GCC attributes
+#endif
+
+// -------------------------------------------------------------------------- //
+
+struct link {
+    struct link* prev; // Previous link in the chain
+    struct link* next; // Next link in the chain
+};
+
+/** Link reset.
+ * @param link Link to reset
+**/
+static void link_reset(struct link* link) {
+    link->prev = link;
+    link->next = link;
+}
+
+/** Link insertion before a "base" link.
+ * @param link Link to insert
+ * @param base Base link relative to which 'link' will be inserted
+**/
+static void link_insert(struct link* link, struct link* base) {
+    struct link* prev = base->prev;
+    link->prev = prev;
+    link->next = base;
+    base->prev = link;
+    prev->next = link;
+}
+
+/** Link removal.
+ * @param link Link to remove
+**/
+static void link_remove(struct link* link) {
+    struct link* prev = link->prev;
+    struct link* next = link->next;
+    prev->next = next;
+    next->prev = prev;
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Make sure a growable array can hold at least the given number of elements.
+ * @param data Pointer to the array base address
+ * @param cap  Pointer to the array capacity (in elements)
+ * @param need Required capacity (in elements)
+ * @param elem Size of one element (in bytes)
+ * @return Whether the operation is a success
+**/
+static bool array_reserve(void** data, size_t* cap, size_t need, size_t elem) {
+    if (likely(need <= *cap))
+        return true;
+    size_t ncap = *cap > 0 ? *cap : 16;
+    while (ncap < need)
+        ncap *= 2;
+    void* ndata = realloc(*data, ncap * elem);
+    if (unlikely(!ndata))
+        return false;
+    *data = ndata;
+    *cap  = ncap;
+    return true;
+}
+
+
+// -------------------------------------------------------------------------- //
+
+struct segment {
+    struct link link;    // Chain of segments of the same state
+    size_t size;         // Usable size of the segment (in bytes)
+    uint_fast64_t stamp; // Sequence lock value after the commit of the transaction that freed the segment, once retired
+};
+
+struct snapshot_slot {
+    _Alignas(64) atomic_uint_fast64_t snapshot; // Snapshot announced by the running transaction, 'SNAPSHOT_FREE' if none
+};
+
+/** Snapshot slot value when no transaction uses it.
+**/
+#define SNAPSHOT_FREE UINT_FAST64_MAX
+
+struct region {
+    atomic_uint_fast64_t seqlock; // Global sequence lock, odd while a writer commits
+    struct snapshot_slot* slots; // Snapshot slots
+    void* start;            // Start of the shared memory region
+    size_t size;            // Size of the shared memory region (in bytes)
+    size_t align;           // Claimed alignment of the shared memory region (in bytes)
+    size_t align_alloc;     // Actual alignment of the memory allocations (in bytes)
+    size_t delta_alloc;     // Space to add at the beginning of the segment for its header (in bytes)
+    pthread_mutex_t alloc_lock; // Protect the segment chains
+    struct link allocs;     // Allocated (and published) segments
+    struct link retired;    // Freed segments, by increasing stamp, until no transaction can reach them
+    size_t nbretired;       // Number of segments in 'retired'
+    atomic_size_t nbslots;  // Number of snapshot slots ever used
+};
+
+struct rentry {
+    uintptr_t addr; // Source address (in shared memory)
+    size_t size;    // Length of the read range (in bytes)
+    size_t value;   // Offset of the observed values in 'rset.values'
+};
+
+struct transaction {
+    uint_fast64_t snapshot; // Sequence lock value the reads are consistent with
+    size_t slot;            // Snapshot slot where the snapshot is announced
+    bool busy;              // Whether the descriptor is in use (see 'tx_acquire')
+    struct {
+        struct rentry* data; // Read ranges
+        char* values;        // Observed values
+        size_t size;
+        size_t cap;
+        size_t vsize;        // Used bytes in 'values'
+        size_t vcap;         // Capacity of 'values' (in bytes)
+    } rset;
+    struct {
+        uintptr_t* data; // Written words
+        char* values;    // Buffered values, one word per entry
+        size_t size;
+        size_t cap;
+        size_t vcap;     // Capacity of 'values' (in bytes)
+        uintptr_t lo;    // Lowest written address, 'UINTPTR_MAX' if none
+        uintptr_t hi;    // End of the highest written word, 0 if none
+    } wset;
+    struct {
+        struct segment** data; // Segments allocated by this transaction
+        size_t size;
+        size_t cap;
+    } allocs;
+    struct {
+        struct segment** data; // Segments freed by this transaction
+        size_t size;
+        size_t cap;
+    } frees;
+};
+
+/** Get the segment header of a segment start address.
+ * @param region Shared memory region
+ * @param addr   Segment start address
+ * @return Segment header
+**/
+static inline struct segment* region_segment(struct region const* region, void* addr) {
+    return (struct segment*) ((uintptr_t) addr - region->delta_alloc);
+}
+
+/** Wait for the sequence lock to be released.
+ * @param region Shared memory region
+ * @return Even sequence lock value
+**/
+static uint_fast64_t region_wait(struct region* region) {
+    while (true) {
+        uint_fast64_t time = atomic_load_explicit(&(region->seqlock), memory_order_acquire);
+        if (likely((time & 1) == 0))
+            return time;
+        sched_yield();
+    }
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Announce a new snapshot in a free slot.
+ * @param region   Shared memory region
+ * @param snapshot Snapshot taken (i.e. even sequence lock value)
+ * @return Slot used, to release at the end of the transaction
+**/
+static size_t snapshot_acquire(struct region* region, uint_fast64_t* snapshot) {
+    static atomic_size_t next_hint = 0;
+    static _Thread_local size_t hint = SIZE_MAX;
+    if (unlikely(hint == SIZE_MAX))
+        hint = atomic_fetch_add_explicit(&next_hint, 1, memory_order_relaxed);
+    size_t const nbslots = 1ul << SNAPSHOT_SLOT_BITS;
+    size_t slot = hint % nbslots;
+    uint_fast64_t time = region_wait(region);
+    while (true) { // Claim a free slot
+        uint_fast64_t expected = SNAPSHOT_FREE;
+        if (likely(atomic_compare_exchange_weak(&(region->slots[slot].snapshot), &expected, time)))
+            break;
+        slot = (slot + 1) % nbslots;
+        if (slot == hint % nbslots)
+            sched_yield();
+    }
+    size_t used = atomic_load_explicit(&(region->nbslots), memory_order_relaxed);
+    while (used <= slot && !atomic_compare_exchange_weak(&(region->nbslots), &used, slot + 1));
+    while (true) { // Make sure the announced snapshot is visible to any reclaiming writer (see 'snapshot_oldest')
+        uint_fast64_t current = region_wait(region);
+        if (likely(current == time))
+            break;
+        time = current;
+        atomic_store(&(region->slots[slot].snapshot), time);
+    }
+    *snapshot = time;
+    return slot;
+}
+
+/** Release a snapshot slot.
+ * @param region Shared memory region
+ * @param slot   Slot to release
+**/
+static void snapshot_release(struct region* region, size_t slot) {
+    atomic_store_explicit(&(region->slots[slot].snapshot), SNAPSHOT_FREE, memory_order_release);
+}
+
+/** Get the oldest snapshot any transaction may use, now or in the future.
+ * @param region Shared memory region
+ * @return Oldest snapshot
+**/
+static uint_fast64_t snapshot_oldest(struct region* region) {
+    uint_fast64_t oldest = atomic_load(&(region->seqlock)); // A snapshot announced after the scan below is at least this value
+    size_t nbslots = atomic_load(&(region->nbslots));
+    for (size_t i = 0; i < nbslots; ++i) {
+        uint_fast64_t snapshot = atomic_load(&(region->slots[i].snapshot));
+        if (snapshot < oldest)
+            oldest = snapshot;
+    }
+    return oldest;
+}
+
+// -------------------------------------------------------------------------- //
+
+static pthread_key_t tx_home_key; // Frees the home descriptor of an exiting thread
+static bool tx_home_keyed = false; // Whether 'tx_home_key' could be created
+static _Thread_local struct transaction* tx_home = NULL; // Descriptor (and buffers) reused by every transaction of the thread
+
+/** Free a transaction descriptor and its buffers.
+ * @param tx Transaction descriptor to free
+**/
+static void tx_destroy(void* tx) {
+    struct transaction* t = (struct transaction*) tx;
+    free(t->rset.data);
+    free(t->rset.values);
+    free(t->wset.data);
+    free(t->wset.values);
+    free(t->allocs.data);
+    free(t->frees.data);
+    free(t);
+}
+
+/** Create the key freeing the home descriptors at thread exit.
+**/
+static void as(constructor) tx_home_setup(void) {
+    tx_home_keyed = pthread_key_create(&tx_home_key, tx_destroy) == 0;
+}
+
+/** Delete the key freeing the home descriptors, and free the one of the unloading thread.
+**/
+static void as(destructor) tx_home_teardown(void) {
+    if (tx_home_keyed)
+        pthread_key_delete(tx_home_key);
+    if (tx_home) {
+        tx_destroy(tx_home);
+        tx_home = NULL;
+    }
+}
+
+/** Get a transaction descriptor, without heap allocation in steady state.
+ * @return Transaction descriptor with empty sets, NULL on failure
+**/
+static struct transaction* tx_acquire(void) {
+    struct transaction* tx = tx_home;
+    if (likely(tx && !tx->busy)) {
+        tx->busy = true;
+        return tx;
+    }
+    tx = (struct transaction*) calloc(1, sizeof(struct transaction));
+    if (unlikely(!tx))
+        return NULL;
+    tx->wset.lo = UINTPTR_MAX;
+    if (!tx_home && tx_home_keyed && pthread_setspecific(tx_home_key, tx) == 0) // First transaction of the thread
+        tx_home = tx;
+    tx->busy = true;
+    return tx;
+}
+
+/** Release a transaction descriptor and its snapshot slot, keeping its buffers for the next transaction of the thread.
+ * @param region Shared memory region
+ * @param tx     Transaction to release
+**/
+static void tx_release(struct region* region, struct transaction* tx) {
+    snapshot_release(region, tx->slot);
+    if (unlikely(tx != tx_home)) { // Concurrent transactions in the same thread
+        tx_destroy(tx);
+        return;
+    }
+    tx->rset.size   = 0;
+    tx->rset.vsize  = 0;
+    tx->wset.size   = 0;
+    tx->wset.lo     = UINTPTR_MAX;
+    tx->wset.hi     = 0;
+    tx->allocs.size = 0;
+    tx->frees.size  = 0;
+    tx->busy = false;
+}
+
+/** Abort a transaction, undoing its speculative allocations and releasing it.
+ * @param region Shared memory region
+ * @param tx     Transaction to abort
+**/
+static void tx_abort(struct region* region, struct transaction* tx) {
+    for (size_t i = 0; i < tx->allocs.size; ++i)
+        free(tx->allocs.data[i]);
+    tx_release(region, tx);
+}
+
+/** Publish the segments allocated by a committing transaction and retire the ones it freed.
+ * @param region Shared memory region
+ * @param tx     Committing transaction
+ * @param stamp  Sequence lock value after the commit of the transaction
+ * @return Whether enough segments are retired to try giving them back (see 'region_reclaim')
+**/
+static bool tx_publish(struct region* region, struct transaction* tx, uint_fast64_t stamp) {
+    if (tx->allocs.size == 0 && tx->frees.size == 0)
+        return false;
+    pthread_mutex_lock(&(region->alloc_lock));
+    for (size_t i = 0; i < tx->allocs.size; ++i)
+        link_insert(&(tx->allocs.data[i]->link), &(region->allocs));
+    for (size_t i = 0; i < tx->frees.size; ++i) {
+        tx->frees.data[i]->stamp = stamp;
+        link_remove(&(tx->frees.data[i]->link));
+        link_insert(&(tx->frees.data[i]->link), &(region->retired));
+    }
+    region->nbretired += tx->frees.size;
+    bool reclaim = region->nbretired >= RECLAIM_BATCH;
+    pthread_mutex_unlock(&(region->alloc_lock));
+    return reclaim;
+}
+
+/** Give back the retired segments no transaction can reach anymore.
+ * @param region Shared memory region
+**/
+static void region_reclaim(struct region* region) {
+    uint_fast64_t oldest = snapshot_oldest(region);
+    struct link stale;
+    link_reset(&stale);
+    pthread_mutex_lock(&(region->alloc_lock));
+    while (true) {
+        struct link* link = region->retired.next;
+        if (link == &(region->retired) || ((struct segment*) link)->stamp > oldest)
+            break;
+        link_remove(link);
+        link_insert(link, &stale);
+        --(region->nbretired);
+    }
+    pthread_mutex_unlock(&(region->alloc_lock));
+    while (stale.next != &stale) {
+        struct link* link = stale.next;
+        link_remove(link);
+        free(link);
+    }
+}
+
+/** Find the write set entry of a given word.
+ * @param tx   Transaction
+ * @param addr Word address
+ * @return Index of the entry, 'tx->wset.size' if not found
+**/
+static size_t tx_wset_find(struct transaction const* tx, uintptr_t addr) {
+    for (size_t i = tx->wset.size; i > 0; --i) {
+        if (tx->wset.data[i - 1] == addr)
+            return i - 1;
+    }
+    return tx->wset.size;
+}
+
+/** Check whether a range may overlap a word of the write set.
+ * @param tx   Transaction
+ * @param addr Start address of the range
+ * @param size Length of the range (in bytes)
+ * @return Whether the range is within the bounds of the written words
+**/
+static inline bool tx_wset_overlaps(struct transaction const* tx, uintptr_t addr, size_t size) {
+    return addr < tx->wset.hi && addr + size > tx->wset.lo;
+}
+
+/** Log a range read from shared memory, merging it with the last read range when contiguous.
+ * @param tx    Transaction
+ * @param addr  Start address of the range
+ * @param value Observed values
+ * @param size  Length of the range (in bytes)
+ * @return Whether the operation is a success
+**/
+static bool tx_rset_log(struct transaction* tx, uintptr_t addr, void const* value, size_t size) {
+    if (unlikely(!array_reserve((void**) &(tx->rset.values), &(tx->rset.vcap), tx->rset.vsize + size, 1)))
+        return false;
+    memcpy(tx->rset.values + tx->rset.vsize, value, size);
+    tx->rset.vsize += size;
+    if (tx->rset.size > 0) {
+        struct rentry* last = tx->rset.data + tx->rset.size - 1;
+        if (last->addr + last->size == addr) {
+            last->size += size;
+            return true;
+        }
+    }
+    if (unlikely(!array_reserve((void**) &(tx->rset.data), &(tx->rset.cap), tx->rset.size + 1, sizeof(*(tx->rset.data)))))
+        return false;
+    tx->rset.data[tx->rset.size++] = (struct rentry){ .addr = addr, .size = size, .value = tx->rset.vsize - size };
+    return true;
+}
+
+/** Validate the read set by value, waiting for any committing writer.
+ * @param region Shared memory region
+ * @param tx     Transaction to validate
+ * @return Whether every logged value is still in shared memory
+**/
+static bool tx_validate(struct region* region, struct transaction* tx) {
+    while (true) {
+        uint_fast64_t time = region_wait(region);
+        for (size_t i = 0; i < tx->rset.size; ++i) {
+            struct rentry const* entry = tx->rset.data + i;
+            if (memcmp((void const*) entry->addr, tx->rset.values + entry->value, entry->size) != 0)
+                return false;
+        }
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&(region->seqlock), memory_order_relaxed) == time) {
+            tx->snapshot = time;
+            atomic_store_explicit(&(region->slots[tx->slot].snapshot), time, memory_order_release); // Every value read is still current, so are the segments they point to
+            return true;
+        }
+    }
+}
+
+/** Read a range none of whose words is in the write set, logging the observed values.
+ * @param region Shared memory region
+ * @param tx     Transaction
+ * @param addr   Start address of the range
+ * @param size   Length of the range (in bytes)
+ * @param target Target start address (in a private region)
+ * @return Whether the read values are consistent with the (possibly revalidated) snapshot
+**/
+static bool tx_read(struct region* region, struct transaction* tx, uintptr_t addr, size_t size, void* target) {
+    memcpy(target, (void const*) addr, size);
+    atomic_thread_fence(memory_order_acquire);
+    while (unlikely(atomic_load_explicit(&(region->seqlock), memory_order_relaxed) != tx->snapshot)) { // Someone committed since the snapshot
+        if (unlikely(!tx_validate(region, tx)))
+            return false;
+        memcpy(target, (void const*) addr, size);
+        atomic_thread_fence(memory_order_acquire);
+    }
+    return tx_rset_log(tx, addr, target, size);
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Create (i.e. allocate + init) a new shared memory region, with one first non-free-able allocated segment of the requested size and alignment.
+ * @param size  Size of the first shared segment of memory to allocate (in bytes), must be a positive multiple of the alignment
+ * @param align Alignment (in bytes, must be a power of 2) that the shared memory region must support
+ * @return Opaque shared memory region handle, 'invalid_shared' on failure
+**/
+shared_t tm_create(size_t size, size_t align) {
+    struct region* region = (struct region*) malloc(sizeof(struct region));
+    if (unlikely(!region))
+        return invalid_shared;
+    size_t align_alloc = align < sizeof(void*) ? sizeof(void*) : align; // Also satisfy alignment requirement of 'struct segment'
+    if (unlikely(posix_memalign(&(region->start), align_alloc, size) != 0)) {
+        free(region);
+        return invalid_shared;
+    }
+    region->slots = (struct snapshot_slot*) aligned_alloc(sizeof(struct snapshot_slot), sizeof(struct snapshot_slot) << SNAPSHOT_SLOT_BITS);
+    if (unlikely(!region->slots)) {
+        free(region->start);
+        free(region);
+        return invalid_shared;
+    }
+    if (unlikely(pthread_mutex_init(&(region->alloc_lock), NULL) != 0)) {
+        free(region->slots);
+        free(region->start);
+        free(region);
+        return invalid_shared;
+    }
+    atomic_init(&(region->nbslots), 0);
+    for (size_t i = 0; i < (1ul << SNAPSHOT_SLOT_BITS); ++i)
+        atomic_init(&(region->slots[i].snapshot), SNAPSHOT_FREE);
+    memset(region->start, 0, size);
+    atomic_init(&(region->seqlock), 0);
+    link_reset(&(region->allocs));
+    link_reset(&(region->retired));
+    region->nbretired   = 0;
+    region->size        = size;
+    region->align       = align;
+    region->align_alloc = align_alloc;
+    region->delta_alloc = (sizeof(struct segment) + align_alloc - 1) / align_alloc * align_alloc;
+    return region;
+}
+
+/** Destroy (i.e. clean-up + free) a given shared memory region.
+ * @param shared Shared memory region to destroy, with no running transaction
+**/
+void tm_destroy(shared_t shared) {
+    struct region* region = (struct region*) shared;
+    struct link* chains[] = { &(region->allocs), &(region->retired) };
+    for (size_t i = 0; i < sizeof(chains) / sizeof(*chains); ++i) {
+        while (true) { // Free segments of the chain
+            struct link* link = chains[i]->next;
+            if (link == chains[i])
+                break;
+            link_remove(link);
+            free(link);
+        }
+    }
+    pthread_mutex_destroy(&(region->alloc_lock));
+    free(region->slots);
+    free(region->start);
+    free(region);
+}
+
+/** [thread-safe] Return the start address of the first allocated segment in the shared memory region.
+ * @param shared Shared memory region to query
+ * @return Start address of the first allocated segment
+**/
+void* tm_start(shared_t shared) {
+    return ((struct region*) shared)->start;
+}
+
+/** [thread-safe] Return the size (in bytes) of the first allocated segment of the shared memory region.
+ * @param shared Shared memory region to query
+ * @return First allocated segment size
+**/
+size_t tm_size(shared_t shared) {
+    return ((struct region*) shared)->size;
+}
+
+/** [thread-safe] Return the alignment (in bytes) of the memory accesses on the given shared memory region.
+ * @param shared Shared memory region to query
+ * @return Alignment used globally
+**/
+size_t tm_align(shared_t shared) {
+    return ((struct region*) shared)->align;
+}
+
+/** [thread-safe] Begin a new transaction on the given shared memory region.
+ * @param shared Shared memory region to start a transaction on
+ * @param is_ro  Whether the transaction is read-only
+ * @return Opaque transaction ID, 'invalid_tx' on failure
+**/
+tx_t tm_begin(shared_t shared, bool is_ro as(unused)) {
+    struct region* region = (struct region*) shared;
+    struct transaction* tx = tx_acquire();
+    if (unlikely(!tx))
+        return invalid_tx;
+    tx->slot = snapshot_acquire(region, &(tx->snapshot));
+    return (tx_t) tx;
+}
+
+/** [thread-safe] End the given transaction.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to end
+ * @return Whether the whole transaction committed
+**/
+bool tm_end(shared_t shared, tx_t tx) {
+    struct region* region = (struct region*) shared;
+    struct transaction* t = (struct transaction*) tx;
+    bool reclaim = false;
+    if (t->wset.size > 0 || t->frees.size > 0) {
+        // Take the sequence lock, revalidating each time someone else committed
+        while (true) {
+            uint_fast64_t expected = t->snapshot;
+            if (atomic_compare_exchange_weak_explicit(&(region->seqlock), &expected, t->snapshot + 1, memory_order_acquire, memory_order_relaxed))
+                break;
+            if (unlikely(!tx_validate(region, t))) {
+                tx_abort(region, t);
+                return false;
+            }
+        }
+        // Replay the write set, publish allocated segments and retire freed ones before releasing (a later transaction may free one of them)
+        for (size_t i = 0; i < t->wset.size; ++i)
+            memcpy((void*) t->wset.data[i], t->wset.values + i * region->align, region->align);
+        reclaim = tx_publish(region, t, t->snapshot + 2);
+        atomic_store_explicit(&(region->seqlock), t->snapshot + 2, memory_order_release);
+    } else {
+        tx_publish(region, t, 0); // Allocated segments only, unreachable from the shared memory
+    }
+    tx_release(region, t);
+    if (unlikely(reclaim))
+        region_reclaim(region);
+    return true;
+}
+
+/** [thread-safe] Read operation in the given transaction, source in the shared region and target in a private region.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param source Source start address (in the shared region)
+ * @param size   Length to copy (in bytes), must be a positive multiple of the alignment
+ * @param target Target start address (in a private region)
+ * @return Whether the whole transaction can continue
+**/
+bool tm_read(shared_t shared, tx_t tx, void const* source, size_t size, void* target) {
+    struct region* region = (struct region*) shared;
+    struct transaction* t = (struct transaction*) tx;
+    if (likely(!tx_wset_overlaps(t, (uintptr_t) source, size))) { // The whole range in one pass
+        if (unlikely(!tx_read(region, t, (uintptr_t) source, size, target))) {
+            tx_abort(region, t);
+            return false;
+        }
+        return true;
+    }
+    size_t align = region->align;
+    for (size_t offset = 0; offset < size; offset += align) {
+        uintptr_t addr = (uintptr_t) source + offset;
+        void* dst = (char*) target + offset;
+        size_t pos = tx_wset_find(t, addr);
+        if (pos < t->wset.size) { // Read-after-write
+            memcpy(dst, t->wset.values + pos * align, align);
+            continue;
+        }
+        if (unlikely(!tx_read(region, t, addr, align, dst))) {
+            tx_abort(region, t);
+            return false;
+        }
+    }
+    return true;
+}
+
+/** [thread-safe] Write operation in the given transaction, source in a private region and target in the shared region.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param source Source start address (in a private region)
+ * @param size   Length to copy (in bytes), must be a positive multiple of the alignment
+ * @param target Target start address (in the shared region)
+ * @return Whether the whole transaction can continue
+**/
+bool tm_write(shared_t shared, tx_t tx, void const* source, size_t size, void* target) {
+    struct region* region = (struct region*) shared;
+    struct transaction* t = (struct transaction*) tx;
+    size_t align = region->align;
+    size_t need  = t->wset.size + size / align;
+    if (unlikely(!array_reserve((void**) &(t->wset.data), &(t->wset.cap), need, sizeof(*(t->wset.data)))
+              || !array_reserve((void**) &(t->wset.values), &(t->wset.vcap), need * align, 1))) {
+        tx_abort(region, t);
+        return false;
+    }
+    bool fresh = !tx_wset_overlaps(t, (uintptr_t) target, size); // No word of the range is in the write set yet
+    for (size_t offset = 0; offset < size; offset += align) {
+        uintptr_t addr = (uintptr_t) target + offset;
+        size_t pos = fresh ? t->wset.size : tx_wset_find(t, addr);
+        if (pos == t->wset.size) // New entry
+            t->wset.data[t->wset.size++] = addr;
+        memcpy(t->wset.values + pos * align, (char const*) source + offset, align);
+    }
+    if ((uintptr_t) target < t->wset.lo)
+        t->wset.lo = (uintptr_t) target;
+    if ((uintptr_t) target + size > t->wset.hi)
+        t->wset.hi = (uintptr_t) target + size;
+    return true;
+}
+
+/** [thread-safe] Memory allocation in the given transaction.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param size   Allocation requested size (in bytes), must be a positive multiple of the alignment
+ * @param target Pointer in private memory receiving the address of the first byte of the newly allocated, aligned segment
+ * @return Whether the whole transaction can continue (success/nomem), or not (abort_alloc)
+**/
+alloc_t tm_alloc(shared_t shared, tx_t tx, size_t size, void** target) {
+    struct region* region = (struct region*) shared;
+    struct transaction* t = (struct transaction*) tx;
+    if (unlikely(!array_reserve((void**) &(t->allocs.data), &(t->allocs.cap), t->allocs.size + 1, sizeof(*(t->allocs.data)))))
+        return nomem_alloc;
+    struct segment* segment;
+    if (unlikely(posix_memalign((void**) &segment, region->align_alloc, region->delta_alloc + size) != 0)) // Allocation failed
+        return nomem_alloc;
+    segment->size = size;
+    t->allocs.data[t->allocs.size++] = segment;
+    void* start = (void*) ((uintptr_t) segment + region->delta_alloc);
+    memset(start, 0, size);
+    *target = start;
+    return success_alloc;
+}
+
+/** [thread-safe] Memory freeing in the given transaction.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param target Address of the first byte of the previously allocated segment to deallocate
+ * @return Whether the whole transaction can continue
+**/
+bool tm_free(shared_t shared, tx_t tx, void* target) {
+    struct region* region = (struct region*) shared;
+    struct transaction* t = (struct transaction*) tx;
+    if (unlikely(!array_reserve((void**) &(t->frees.data), &(t->frees.cap), t->frees.size + 1, sizeof(*(t->frees.data))))) {
+        tx_abort(region, t);
+        return false;
+    }
+    // NOTE: A segment allocated by this very transaction is published then retired at commit (see 'tm_end'), or freed on abort
+    t->frees.data[t->frees.size++] = region_segment(region, target);
+    return true;
+}
@@ -8,22 +8,108 @@
  *
  * @section DESCRIPTION
  *
- * Implementation of your own transaction manager.
- * You can completely rewrite this file (and create more files) as you wish.
- * Only the interface (i.e. exported symbols and semantic) must be preserved.
+ * TL2-style word-based transaction manager implementation.
+ *
+ * Every shared stripe (a word of the region's alignment by default) maps to a
+ * versioned lock of a global lock table. A global version clock orders the commits: reads are
+ * validated against the clock value sampled at 'tm_begin', writes are buffered
+ * in a per-transaction write set, and a committing transaction locks its write
+ * set, takes a new version, validates its read set and then writes back.
+ *
+ * Read-only transactions are invisible: they have no descriptor (their handle
+ * encodes their read version), keep no read set and never need validation.
+ *
+ * The way commits advance the global version clock is chosen at build time: a
+ * plain increment, an increment that adopts the value of a concurrent commit
+ * instead of retrying (GV4), or no increment at all, the clock being advanced
+ * by the transactions that abort on a too recent version instead (GV5).
+ *
+ * Shared addresses are opaque: the upper bits hold the identifier of the
+ * segment in the segment table, the lower bits the offset in the segment.
+ * Translating an address or finding its versioned lock is then arithmetic on
+ * one segment table entry, and freeing a segment needs no search.
+ *
+ * Freed segments are reclaimed with epochs, the clock serving as the epoch:
+ * every transaction announces its read version in a slot for its duration, and
+ * a segment retired at write version 'wv' is given back, in batches, once no
+ * announced read version is below 'wv' (no transaction can reach it anymore).
+ *
+ * Segment memory of small sizes comes in power-of-two size classes, and each
+ * thread keeps a cache of free blocks per class (in its home descriptor): the
+ * segments it frees or whose allocation it rolls back are reused by its next
+ * allocations without going through the C library. A background thread zeroes
+ * the surplus of these caches and hands it back as zeroed blocks, so that most
+ * allocations need no zeroing; large segments come from anonymous mappings,
+ * which the kernel zeroes lazily.
+ *
+ * Contention management is chosen at build time: a transaction retried after
+ * aborts may back off before starting, wait longer for locked words the more
+ * it aborted, and take a serialization token that keeps new read-write
+ * transactions from starting until it commits. A transaction that keeps
+ * aborting eventually becomes irrevocable: it takes the token exclusively, waits
+ * for every running transaction to end, and then reads and writes in place.
+ *
+ * Each thread counts its commits, its aborts by cause and the bytes buffered in
+ * its write sets, which 'tm_stats' (see 'tm_stats.h') reports.
 **/
 
+// Compile-time configuration
+#define LOCK_TABLE_BITS     20 // Log2 of the number of versioned locks in the lock table
+#define SEGMENT_ID_BITS     16 // Log2 of the number of entries in the segment table
+#define SEGMENT_OFFSET_BITS 48 // Number of lower bits of a shared address holding the offset in the segment
+#define EPOCH_SLOT_BITS     8  // Log2 of the number of slots where running transactions announce their read version
+#define RECLAIM_BATCH       16 // Number of retired segments that triggers a reclamation pass
+#define SLAB_MIN_BITS       6  // Log2 of the smallest size class (in bytes), also the alignment of every block
+#define SLAB_MAX_BITS       16 // Log2 of the largest size class (in bytes), larger segments bypass the size classes
+#define SLAB_CACHE_SIZE     64 // Maximum number of free blocks a thread keeps per size class
+#define ZERO_POOL_BATCH     16 // Number of blocks moved at once between a thread and the zeroed block pools
+#define ZERO_POOL_SIZE      256 // Maximum number of blocks per size class in the zeroed block pools
+// #define USE_CLOCK_GV4     // A commit that loses the race to increment the clock adopts the value published by the winner
+// #define USE_CLOCK_GV5     // A commit takes the clock value plus one without incrementing it, aborting transactions advance the clock
+// #define USE_LOCK_PADDING  // Give each versioned lock its own cache line
+// #define USE_STRIPE_16B    // One versioned lock per 16-byte stripe (or per word if larger)
+// #define USE_STRIPE_64B    // One versioned lock per 64-byte stripe (or per word if larger)
+#define USE_CM_BACKOFF       // Randomized exponential backoff before retrying an aborted transaction
+#define USE_CM_KARMA         // Wait for locked words before aborting, longer for transactions that aborted more
+#define CM_SERIALIZE_AFTER 32 // Number of consecutive aborts after which a transaction takes the serialization token (0 for never)
+#define CM_IRREVOCABLE_AFTER 64 // Number of consecutive aborts after which a transaction runs irrevocably, alone and in place (0 for never)
+// #define USE_CM_REPORT     // Print how often each contention management path was taken when a region is destroyed
+#define CM_BACKOFF_MAX_BITS 10 // Log2 of the maximal number of pauses of a backoff
+#define CM_WAIT_PAUSES      32 // Number of pauses a transaction waits for a locked word per abort it suffered
+#define COMMIT_SORT_INSERTION 16 // Largest write set sorted by insertion at commit, larger ones are sorted with 'qsort_r'
+#define COMMIT_PREFETCH_DISTANCE 8 // Number of write set entries between the one being locked and the one being prefetched
+#define RSET_VECTOR_MIN     16 // Smallest read set validated with the vector kernels
+// #define USE_RSET_SCALAR   // Always validate the read set with the scalar loop, even on CPUs with vector extensions
+
 // Requested features
 #define _GNU_SOURCE
 #define _POSIX_C_SOURCE   200809L
+#if defined(USE_CLOCK_GV4) && defined(USE_CLOCK_GV5)
+    #error At most one global version clock strategy can be selected
+#endif
 #ifdef __STDC_NO_ATOMICS__
     #error Current C11 compiler does not support atomic operations
 #endif
 
 // External headers
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__i386__) || defined(__x86_64__)
+    #include <immintrin.h>
+#endif
+#if defined(USE_CM_REPORT)
+    #include <stdio.h>
+#endif
 
 // Internal headers
 #include <tm.h>
+#include <tm_stats.h>
 
 // -------------------------------------------------------------------------- //
 
@@ -63,6 +149,1493 @@
     #warning This compiler has no support for GCC attributes
 #endif
 
+/** Hint that some memory is about to be written.
+ * @param addr Address to prefetch
+**/
+#undef prefetch_write
+#ifdef __GNUC__
+    #define prefetch_write(addr) \
+        __builtin_prefetch((addr), 1)
+#else
+    #define prefetch_write(addr)
+#endif
+
+// -------------------------------------------------------------------------- //
+
+/** Make sure a growable array can hold at least the given number of elements.
+ * @param data Pointer to the array base address
+ * @param cap  Pointer to the array capacity (in elements)
+ * @param need Required capacity (in elements)
+ * @param elem Size of one element (in bytes)
+ * @return Whether the operation is a success
+**/
+static bool array_reserve(void** data, size_t* cap, size_t need, size_t elem) {
+    if (likely(need <= *cap))
+        return true;
+    size_t ncap = *cap > 0 ? *cap : 16;
+    while (ncap < need)
+        ncap *= 2;
+    void* ndata = realloc(*data, ncap * elem);
+    if (unlikely(!ndata))
+        return false;
+    *data = ndata;
+    *cap  = ncap;
+    return true;
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Versioned lock word: version in the upper bits, lock bit in the LSB.
+**/
+typedef uint_fast64_t vword_t;
+typedef atomic_uint_fast64_t vlock_t;
+
+/** Log2 of the minimal stripe size (in bytes), i.e. of the length of shared memory a versioned lock protects.
+**/
+#if defined(USE_STRIPE_64B)
+    #define LOCK_STRIPE_BITS 6
+#elif defined(USE_STRIPE_16B)
+    #define LOCK_STRIPE_BITS 4
+#else
+    #define LOCK_STRIPE_BITS 0
+#endif
+
+/** Log2 of the distance between two consecutive versioned locks in the lock table (in lock words).
+**/
+#if defined(USE_LOCK_PADDING)
+    #define LOCK_PAD_BITS 3 // 64-byte cache lines
+#else
+    #define LOCK_PAD_BITS 0
+#endif
+
+/** Size of the lock table (in bytes).
+**/
+#define LOCK_TABLE_SIZE (sizeof(vlock_t) << (LOCK_TABLE_BITS + LOCK_PAD_BITS))
+
+/** Check whether a versioned lock word is locked.
+ * @param word Versioned lock word
+ * @return Whether the word is locked
+**/
+static inline bool vword_locked(vword_t word) {
+    return (word & 1) != 0;
+}
+
+/** Get the version of a versioned lock word.
+ * @param word Versioned lock word
+ * @return Version
+**/
+static inline uint_fast64_t vword_version(vword_t word) {
+    return word >> 1;
+}
+
+/** Build an unlocked versioned lock word.
+ * @param version Version
+ * @return Versioned lock word
+**/
+static inline vword_t vword_make(uint_fast64_t version) {
+    return version << 1;
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Epoch slot value when no transaction uses it.
+**/
+#define EPOCH_FREE UINT_FAST64_MAX
+
+/** States of the serialization token of a region.
+**/
+#define TOKEN_FREE        0 // No transaction holds the token
+#define TOKEN_SERIAL      1 // A transaction holds the token, new read-write transactions wait
+#define TOKEN_IRREVOCABLE 2 // An irrevocable transaction holds the token, every new transaction waits
+
+struct segment {
+    char*  base;  // Start of the segment's memory, NULL if the identifier is not in use
+    size_t size;  // Size of the segment (in bytes)
+    size_t locks; // Index in the lock table of the versioned lock of the first stripe
+    atomic_size_t next_free; // Next identifier in the stack of unused identifiers (see 'region_id_acquire')
+};
+
+struct retired {
+    struct retired* next; // Next batch in the chain
+    uint_fast64_t stamp;  // Write version of the transaction that freed the segments
+    size_t size;          // Number of segments
+    size_t ids[];         // Identifiers of the freed segments
+};
+
+struct epoch_slot {
+    _Alignas(64) atomic_uint_fast64_t rv; // Read version announced by the running transaction, 'EPOCH_FREE' if none
+};
+
+struct region { // NOTE: The clock, the fields read by every access and the allocation fields are on distinct cache lines
+    _Alignas(64) atomic_uint_fast64_t clock; // Global version clock
+    atomic_uint token;      // State of the serialization token, a 'TOKEN_*' value (see 'cm_begin')
+    _Alignas(64) vlock_t* locks; // Versioned lock table
+    size_t word_shift;      // Log2 of the alignment, to map an address to its word index
+    size_t stripe_shift;    // Log2 of the stripe size, to map an address to its stripe index
+    struct segment* segments; // Segment table, indexed by segment identifier (identifier 0 is never used, so that no address is NULL)
+    struct epoch_slot* slots; // Epoch slots
+    void* start;            // Start of the shared memory region
+    size_t size;            // Size of the shared memory region (in bytes)
+    size_t align;           // Claimed alignment of the shared memory region (in bytes)
+    size_t align_alloc;     // Actual alignment of the memory allocations (in bytes)
+    _Alignas(64) atomic_size_t next_id; // Lowest segment identifier never used
+    atomic_size_t next_lock; // Index of the versioned lock of the first stripe of the next allocated segment, so that segments get contiguous locks
+    atomic_uint_fast64_t free_ids; // Top of the stack of unused identifiers (lower 32 bits, 0 if empty) and modification count (upper 32 bits, against ABA)
+    _Atomic(struct retired*) retired; // Chain of retired segments, waiting for every transaction that could reach them to end
+    atomic_size_t nbretired; // Number of segments in 'retired'
+    atomic_size_t nbslots;  // Number of epoch slots ever used
+    atomic_size_t cm_backoffs; // Number of backoffs before a retry
+    atomic_size_t cm_waits;    // Number of locked words waited for (successfully or not)
+    atomic_size_t cm_serials;  // Number of serialization token acquisitions
+    atomic_size_t cm_irrevocables; // Number of irrevocable transactions
+};
+
+struct wentry {
+    uintptr_t addr; // Target word address (in shared memory)
+    vlock_t*  lock; // Associated versioned lock
+};
+
+struct wslot {
+    uint32_t entry; // Index of the write set (or held lock) entry
+    uint32_t gen;   // Generation of the set the slot belongs to (see 'struct transaction')
+};
+
+struct acquired {
+    vlock_t* lock; // Acquired versioned lock
+    vword_t  word; // Versioned lock word before acquisition
+};
+
+struct transaction {
+    uint_fast64_t rv; // Read version, i.e. clock value at begin
+    atomic_uint_fast64_t* epoch; // Epoch slot where the read version is announced
+    bool busy;        // Whether the descriptor is in use (see 'tx_acquire')
+    bool irrevocable; // Whether the transaction runs alone, reading and writing in place
+    uint64_t logged;  // Bytes buffered in the write set by the transactions of the thread, only counted in the home descriptor (see 'tm_stats')
+    struct {
+        vlock_t** data; // Versioned locks of the read words
+        size_t size;
+        size_t cap;
+    } rset;
+    struct {
+        struct wentry* data; // Written words, in insertion order
+        char* values;        // Buffered values, one word per entry
+        size_t size;
+        size_t cap;
+        size_t vcap;         // Capacity of 'values' (in words)
+        struct wslot* index; // Open-addressed (linear probing) hash table of the entries, keyed by address
+        size_t ibits;        // Log2 of the capacity of 'index' (in slots), 0 if not allocated
+        uint32_t gen;        // Current generation, slots of other generations are empty
+        uint64_t bloom;      // One-hash bloom filter of the written addresses
+        bool unsorted;       // Whether an entry was inserted after an entry of higher address
+        uint32_t* order;     // Entries by increasing address, filled at commit if 'unsorted'
+        size_t ocap;         // Capacity of 'order' (in entries)
+    } wset;
+    struct {
+        struct acquired* data; // Locks held during commit
+        size_t size;
+        size_t cap;
+        struct wslot* index; // Open-addressed (linear probing) hash table of the entries, keyed by lock
+        size_t ibits;        // Log2 of the capacity of 'index' (in slots), 0 if not allocated
+        uint32_t gen;        // Current generation, slots of other generations are empty
+    } held;
+    struct {
+        size_t* data; // Identifiers of the segments allocated by this transaction
+        size_t size;
+        size_t cap;
+    } allocs;
+    struct {
+        size_t* data; // Identifiers of the segments freed by this transaction
+        size_t size;
+        size_t cap;
+    } frees;
+    struct {
+        void* dirty;    // First free block to zero before use, each free block starting with the address of the next one
+        size_t nbdirty; // Number of free blocks to zero before use
+        void* clean;    // First zeroed free block (but for the address of the next one)
+        size_t nbclean; // Number of zeroed free blocks
+    } slabs[SLAB_MAX_BITS - SLAB_MIN_BITS + 1]; // Free blocks of each size class, only used in the home descriptor
+};
+
+/** Check whether a transaction handle designates a read-only transaction.
+ * @param tx Transaction handle
+ * @return Whether the transaction is read-only
+**/
+static inline bool tx_is_ro(tx_t tx) {
+    return (tx & 1) != 0; // Descriptors are at least 2-byte aligned
+}
+
+/** Build the handle of a read-only transaction.
+ * @param rv   Read version
+ * @param slot Epoch slot used
+ * @return Transaction handle
+**/
+static inline tx_t tx_make_ro(uint_fast64_t rv, size_t slot) {
+    return (tx_t) ((((rv << EPOCH_SLOT_BITS) | slot) << 1) | 1);
+}
+
+/** Get the read version of a read-only transaction.
+ * @param tx Transaction handle
+ * @return Read version
+**/
+static inline uint_fast64_t tx_ro_rv(tx_t tx) {
+    return (uint_fast64_t) (tx >> (EPOCH_SLOT_BITS + 1));
+}
+
+/** Get the epoch slot of a read-only transaction.
+ * @param tx Transaction handle
+ * @return Epoch slot
+**/
+static inline size_t tx_ro_slot(tx_t tx) {
+    return (size_t) ((tx >> 1) & ((1ul << EPOCH_SLOT_BITS) - 1));
+}
+
+/** Build a shared address.
+ * @param id     Segment identifier
+ * @param offset Offset in the segment (in bytes)
+ * @return Shared address
+**/
+static inline uintptr_t addr_make(size_t id, size_t offset) {
+    return ((uintptr_t) id << SEGMENT_OFFSET_BITS) | (uintptr_t) offset;
+}
+
+/** Get the segment identifier of a shared address.
+ * @param addr Shared address
+ * @return Segment identifier
+**/
+static inline size_t addr_id(uintptr_t addr) {
+    return (size_t) (addr >> SEGMENT_OFFSET_BITS);
+}
+
+/** Get the offset in its segment of a shared address.
+ * @param addr Shared address
+ * @return Offset (in bytes)
+**/
+static inline size_t addr_offset(uintptr_t addr) {
+    return (size_t) (addr & ((UINTMAX_C(1) << SEGMENT_OFFSET_BITS) - 1));
+}
+
+/** Translate a shared address into the address of the actual memory.
+ * @param region Shared memory region
+ * @param addr   Shared address
+ * @return Actual memory address
+**/
+static inline void* region_translate(struct region const* region, uintptr_t addr) {
+    return region->segments[addr_id(addr)].base + addr_offset(addr);
+}
+
+/** Get the number of stripes of a segment.
+ * @param region Shared memory region
+ * @param size   Size of the segment (in bytes)
+ * @return Number of stripes
+**/
+static inline size_t region_stripes(struct region const* region, size_t size) {
+    return (size + (1ul << region->stripe_shift) - 1) >> region->stripe_shift;
+}
+
+/** Get the (unwrapped) index in the lock table of the versioned lock protecting a given word.
+ * @param region Shared memory region
+ * @param addr   Shared word address
+ * @return Index of the associated versioned lock, the following stripes of the segment map to the following indexes
+**/
+static inline size_t region_lock_index(struct region const* region, uintptr_t addr) {
+    return region->segments[addr_id(addr)].locks + (addr_offset(addr) >> region->stripe_shift);
+}
+
+/** Get the versioned lock at a given (unwrapped) index.
+ * @param locks Versioned lock table
+ * @param index Lock index
+ * @return Associated versioned lock
+**/
+static inline vlock_t* lock_at(vlock_t const* locks, size_t index) {
+    return (vlock_t*) locks + ((index & ((1ul << LOCK_TABLE_BITS) - 1)) << LOCK_PAD_BITS);
+}
+
+/** Get the versioned lock at a given (unwrapped) index.
+ * @param region Shared memory region
+ * @param index  Lock index
+ * @return Associated versioned lock
+**/
+static inline vlock_t* region_lock_at(struct region const* region, size_t index) {
+    return lock_at(region->locks, index);
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Free a chain of blocks.
+ * @param block First block of the chain, each block starting with the address of the next one
+**/
+static void block_free(void* block) {
+    while (block) {
+        void* next = *((void**) block);
+        free(block);
+        block = next;
+    }
+}
+
+static pthread_key_t tx_home_key; // Frees the home descriptor of an exiting thread
+static bool tx_home_keyed = false; // Whether 'tx_home_key' could be created
+static _Thread_local struct transaction* tx_home = NULL; // Descriptor (and buffers) reused by every transaction of the thread
+
+/** Free a transaction descriptor and its buffers.
+ * @param tx Transaction descriptor to free
+**/
+static void tx_destroy(void* tx) {
+    struct transaction* t = (struct transaction*) tx;
+    free(t->rset.data);
+    free(t->wset.data);
+    free(t->wset.values);
+    free(t->wset.index);
+    free(t->wset.order);
+    free(t->held.data);
+    free(t->held.index);
+    free(t->allocs.data);
+    free(t->frees.data);
+    for (size_t i = 0; i < sizeof(t->slabs) / sizeof(*(t->slabs)); ++i) {
+        block_free(t->slabs[i].dirty);
+        block_free(t->slabs[i].clean);
+    }
+    free(t);
+}
+
+/** Create the key freeing the home descriptors at thread exit.
+**/
+static void as(constructor) tx_home_setup(void) {
+    tx_home_keyed = pthread_key_create(&tx_home_key, tx_destroy) == 0;
+}
+
+/** Delete the key freeing the home descriptors, and free the one of the unloading thread.
+**/
+static void as(destructor) tx_home_teardown(void) {
+    if (tx_home_keyed)
+        pthread_key_delete(tx_home_key);
+    if (tx_home) {
+        tx_destroy(tx_home);
+        tx_home = NULL;
+    }
+}
+
+// -------------------------------------------------------------------------- //
+
+struct zero_pool {
+    pthread_mutex_t lock;  // Protect the fields below
+    void* dirty;           // Blocks to zero, chained through their first word
+    size_t nbdirty;        // Number of blocks to zero
+    void* clean;           // Zeroed blocks (but for their first word, chaining them)
+    atomic_size_t nbclean; // Number of zeroed blocks, read without the lock to skip empty pools
+    size_t wanted;         // Number of new zeroed blocks asked by allocating threads
+};
+
+static size_t page_size = 4096; // Granularity of anonymous mappings (see 'zero_setup')
+static struct zero_pool zero_pools[SLAB_MAX_BITS - SLAB_MIN_BITS + 1]; // Zeroed block pools, one per size class
+static pthread_mutex_t zero_lock = PTHREAD_MUTEX_INITIALIZER; // Protect the zeroing thread state below
+static pthread_cond_t zero_cond = PTHREAD_COND_INITIALIZER;  // Wake the zeroing thread up
+static bool zero_pending = false;  // Whether some pool has blocks to zero or asks for new blocks
+static bool zero_stop = false;     // Whether the zeroing thread must exit
+static bool zero_running = false;  // Whether the zeroing thread was started
+static pthread_t zero_thread;      // Zeroing thread
+static pthread_once_t zero_once = PTHREAD_ONCE_INIT; // Start the zeroing thread once
+
+/** Get the size class of a segment.
+ * @param region Shared memory region
+ * @param size   Size of the segment (in bytes)
+ * @return Size class, 'SIZE_MAX' if the segment bypasses the size classes
+**/
+static inline size_t slab_class(struct region const* region, size_t size) {
+    if (region->align_alloc > (1ul << SLAB_MIN_BITS) || size > (1ul << SLAB_MAX_BITS))
+        return SIZE_MAX;
+    if (size <= (1ul << SLAB_MIN_BITS))
+        return 0;
+    return (size_t) (64 - __builtin_clzl(size - 1)) - SLAB_MIN_BITS;
+}
+
+/** Check whether the memory of a segment bypassing the size classes is an anonymous mapping.
+ * @param region Shared memory region
+ * @param size   Size of the segment (in bytes)
+ * @return Whether the segment is mapped
+**/
+static inline bool slab_mapped(struct region const* region, size_t size) {
+    return size > (1ul << SLAB_MAX_BITS) && region->align_alloc <= page_size;
+}
+
+/** Zero the blocks to zero of a pool, and make the new blocks it asks for.
+ * @param class Size class of the pool
+**/
+static void zero_fill(size_t class) {
+    struct zero_pool* pool = zero_pools + class;
+    size_t bsize = 1ul << (class + SLAB_MIN_BITS);
+    pthread_mutex_lock(&(pool->lock));
+    void* dirty = pool->dirty;
+    size_t wanted = pool->wanted;
+    pool->dirty   = NULL;
+    pool->nbdirty = 0;
+    pool->wanted  = 0;
+    pthread_mutex_unlock(&(pool->lock));
+    if (!dirty && wanted == 0)
+        return;
+    void* clean = NULL;
+    void* last  = NULL; // Last block of 'clean'
+    size_t nbclean = 0;
+    while (true) { // Zero (or make) blocks, outside of the pool lock
+        void* block = dirty;
+        if (block) {
+            dirty = *((void**) block);
+        } else if (wanted > 0 && posix_memalign(&block, 1ul << SLAB_MIN_BITS, bsize) == 0) {
+            --wanted;
+        } else {
+            break;
+        }
+        memset(block, 0, bsize);
+        *((void**) block) = clean;
+        clean = block;
+        if (!last)
+            last = block;
+        ++nbclean;
+    }
+    if (!clean)
+        return;
+    pthread_mutex_lock(&(pool->lock));
+    *((void**) last) = pool->clean;
+    pool->clean = clean;
+    atomic_store_explicit(&(pool->nbclean), atomic_load_explicit(&(pool->nbclean), memory_order_relaxed) + nbclean, memory_order_relaxed);
+    pthread_mutex_unlock(&(pool->lock));
+}
+
+/** Zeroing thread entry point.
+ * @param arg Unused
+ * @return Unused
+**/
+static void* zero_run(void* arg as(unused)) {
+    pthread_mutex_lock(&zero_lock);
+    while (true) {
+        while (!zero_pending && !zero_stop)
+            pthread_cond_wait(&zero_cond, &zero_lock);
+        if (zero_stop)
+            break;
+        zero_pending = false;
+        pthread_mutex_unlock(&zero_lock);
+        for (size_t i = 0; i < sizeof(zero_pools) / sizeof(*zero_pools); ++i)
+            zero_fill(i);
+        pthread_mutex_lock(&zero_lock);
+    }
+    pthread_mutex_unlock(&zero_lock);
+    return NULL;
+}
+
+/** Start the zeroing thread.
+**/
+static void zero_start(void) {
+    zero_running = pthread_create(&zero_thread, NULL, zero_run, NULL) == 0;
+}
+
+/** Wake the zeroing thread up.
+**/
+static void zero_notify(void) {
+    pthread_mutex_lock(&zero_lock);
+    zero_pending = true;
+    pthread_cond_signal(&zero_cond);
+    pthread_mutex_unlock(&zero_lock);
+}
+
+/** Initialize the zeroed block pools.
+**/
+static void as(constructor) zero_setup(void) {
+    long size = sysconf(_SC_PAGESIZE);
+    if (likely(size > 0))
+        page_size = (size_t) size;
+    for (size_t i = 0; i < sizeof(zero_pools) / sizeof(*zero_pools); ++i) {
+        pthread_mutex_init(&(zero_pools[i].lock), NULL);
+        atomic_init(&(zero_pools[i].nbclean), 0);
+    }
+}
+
+/** Stop the zeroing thread, and free the zeroed block pools.
+**/
+static void as(destructor) zero_teardown(void) {
+    if (zero_running) {
+        pthread_mutex_lock(&zero_lock);
+        zero_stop = true;
+        pthread_cond_signal(&zero_cond);
+        pthread_mutex_unlock(&zero_lock);
+        pthread_join(zero_thread, NULL);
+        zero_running = false;
+    }
+    for (size_t i = 0; i < sizeof(zero_pools) / sizeof(*zero_pools); ++i) {
+        block_free(zero_pools[i].dirty);
+        block_free(zero_pools[i].clean);
+        pthread_mutex_destroy(&(zero_pools[i].lock));
+    }
+}
+
+/** Move a batch of zeroed blocks from the pool to the cache of a thread, or ask the zeroing thread for more.
+ * @param home  Home descriptor of the thread
+ * @param class Size class
+**/
+static void zero_take(struct transaction* home, size_t class) {
+    struct zero_pool* pool = zero_pools + class;
+    bool notify = false;
+    pthread_mutex_lock(&(pool->lock));
+    size_t count = 0;
+    while (count < ZERO_POOL_BATCH && pool->clean) {
+        void* block = pool->clean;
+        pool->clean = *((void**) block);
+        *((void**) block) = home->slabs[class].clean;
+        home->slabs[class].clean = block;
+        ++count;
+    }
+    atomic_store_explicit(&(pool->nbclean), atomic_load_explicit(&(pool->nbclean), memory_order_relaxed) - count, memory_order_relaxed);
+    if (count < ZERO_POOL_BATCH && pool->wanted == 0) {
+        pool->wanted = ZERO_POOL_BATCH;
+        notify = true;
+    }
+    pthread_mutex_unlock(&(pool->lock));
+    home->slabs[class].nbclean += count;
+    if (notify && zero_running)
+        zero_notify();
+}
+
+/** Move a batch of blocks from the cache of a thread to the pool, for the zeroing thread to zero them.
+ * @param home  Home descriptor of the thread
+ * @param class Size class
+**/
+static void zero_give(struct transaction* home, size_t class) {
+    struct zero_pool* pool = zero_pools + class;
+    void* batch = home->slabs[class].dirty;
+    void* last  = batch;
+    for (size_t i = 1; i < ZERO_POOL_BATCH; ++i)
+        last = *((void**) last);
+    home->slabs[class].dirty = *((void**) last);
+    home->slabs[class].nbdirty -= ZERO_POOL_BATCH;
+    pthread_mutex_lock(&(pool->lock));
+    bool accepted = zero_running && pool->nbdirty + atomic_load_explicit(&(pool->nbclean), memory_order_relaxed) < ZERO_POOL_SIZE;
+    if (accepted) {
+        *((void**) last) = pool->dirty;
+        pool->dirty = batch;
+        pool->nbdirty += ZERO_POOL_BATCH;
+    }
+    pthread_mutex_unlock(&(pool->lock));
+    if (accepted) {
+        zero_notify();
+    } else {
+        *((void**) last) = NULL;
+        block_free(batch);
+    }
+}
+
+/** Get zeroed memory for a new segment, preferably from the zeroed, then free blocks of the thread.
+ * @param region Shared memory region
+ * @param size   Size of the segment (in bytes)
+ * @return Segment memory, NULL on failure
+**/
+static void* slab_get(struct region const* region, size_t size) {
+    void* base;
+    size_t class = slab_class(region, size);
+    if (class == SIZE_MAX) {
+        if (slab_mapped(region, size)) { // Zeroed on first touch by the kernel
+            base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            return base == MAP_FAILED ? NULL : base;
+        }
+        if (unlikely(posix_memalign(&base, region->align_alloc, size) != 0))
+            return NULL;
+        memset(base, 0, size);
+        return base;
+    }
+    struct transaction* home = tx_home;
+    if (likely(home)) {
+        if (!home->slabs[class].clean && atomic_load_explicit(&(zero_pools[class].nbclean), memory_order_relaxed) > 0)
+            zero_take(home, class);
+        if (likely(home->slabs[class].clean)) {
+            base = home->slabs[class].clean;
+            home->slabs[class].clean = *((void**) base);
+            --(home->slabs[class].nbclean);
+            *((void**) base) = NULL;
+            return base;
+        }
+        if (home->slabs[class].dirty) {
+            base = home->slabs[class].dirty;
+            home->slabs[class].dirty = *((void**) base);
+            --(home->slabs[class].nbdirty);
+            memset(base, 0, size);
+            return base;
+        }
+        zero_take(home, class); // Ask for zeroed blocks for the next allocations
+    }
+    if (unlikely(posix_memalign(&base, 1ul << SLAB_MIN_BITS, 1ul << (class + SLAB_MIN_BITS)) != 0))
+        return NULL;
+    memset(base, 0, size);
+    return base;
+}
+
+/** Give back the memory of a segment, to the free blocks of the thread if possible.
+ * @param region Shared memory region
+ * @param base   Segment memory
+ * @param size   Size of the segment (in bytes)
+**/
+static void slab_put(struct region const* region, void* base, size_t size) {
+    size_t class = slab_class(region, size);
+    if (class == SIZE_MAX) {
+        if (slab_mapped(region, size)) {
+            munmap(base, size);
+        } else {
+            free(base);
+        }
+        return;
+    }
+    struct transaction* home = tx_home;
+    if (unlikely(!home)) {
+        free(base);
+        return;
+    }
+    *((void**) base) = home->slabs[class].dirty;
+    home->slabs[class].dirty = base;
+    if (++(home->slabs[class].nbdirty) >= SLAB_CACHE_SIZE + ZERO_POOL_BATCH) // Hand the surplus over to the zeroing thread
+        zero_give(home, class);
+}
+
+/** Get an unused segment identifier.
+ * @param region Shared memory region
+ * @return Segment identifier, 0 if none is available
+**/
+static size_t region_id_acquire(struct region* region) {
+    uint_fast64_t top = atomic_load_explicit(&(region->free_ids), memory_order_acquire);
+    while (true) { // Pop from the stack of unused identifiers
+        size_t id = (size_t) (top & UINT32_MAX);
+        if (id == 0)
+            break;
+        uint_fast64_t next = ((top >> 32) + 1) << 32 | atomic_load_explicit(&(region->segments[id].next_free), memory_order_relaxed);
+        if (atomic_compare_exchange_weak_explicit(&(region->free_ids), &top, next, memory_order_acquire, memory_order_acquire))
+            return id;
+    }
+    size_t id = atomic_fetch_add_explicit(&(region->next_id), 1, memory_order_relaxed);
+    if (unlikely(id >= (1ul << SEGMENT_ID_BITS))) { // Segment table full
+        atomic_store_explicit(&(region->next_id), 1ul << SEGMENT_ID_BITS, memory_order_relaxed);
+        return 0;
+    }
+    return id;
+}
+
+/** Free a segment and give back its identifier, no running or future transaction being able to reach it.
+ * @param region Shared memory region
+ * @param id     Segment identifier
+**/
+static void region_id_release(struct region* region, size_t id) {
+    struct segment* segment = region->segments + id;
+    if (segment->base) {
+        slab_put(region, segment->base, segment->size);
+        segment->base = NULL;
+    }
+    uint_fast64_t top = atomic_load_explicit(&(region->free_ids), memory_order_relaxed);
+    do { // Push on the stack of unused identifiers
+        atomic_store_explicit(&(segment->next_free), (size_t) (top & UINT32_MAX), memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&(region->free_ids), &top, ((top >> 32) + 1) << 32 | id, memory_order_release, memory_order_relaxed));
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Announce the read version of a starting transaction in a free epoch slot.
+ * @param region Shared memory region
+ * @param rv     Read version taken
+ * @return Slot used, to release at the end of the transaction
+**/
+static size_t epoch_enter(struct region* region, uint_fast64_t* rv) {
+    static atomic_size_t next_hint = 0;
+    static _Thread_local size_t hint = SIZE_MAX;
+    if (unlikely(hint == SIZE_MAX))
+        hint = atomic_fetch_add_explicit(&next_hint, 1, memory_order_relaxed);
+    size_t const nbslots = 1ul << EPOCH_SLOT_BITS;
+    size_t slot = hint % nbslots;
+    uint_fast64_t version = atomic_load(&(region->clock));
+    while (true) { // Claim a free slot
+        uint_fast64_t expected = EPOCH_FREE;
+        if (likely(atomic_compare_exchange_weak(&(region->slots[slot].rv), &expected, version)))
+            break;
+        slot = (slot + 1) % nbslots;
+        if (slot == hint % nbslots)
+            sched_yield();
+    }
+    size_t used = atomic_load_explicit(&(region->nbslots), memory_order_relaxed);
+    while (used <= slot && !atomic_compare_exchange_weak(&(region->nbslots), &used, slot + 1));
+    while (true) { // Make sure the announced version is visible to any reclaiming transaction (see 'epoch_oldest')
+        uint_fast64_t current = atomic_load(&(region->clock));
+        if (likely(current == version))
+            break;
+        version = current;
+        atomic_store(&(region->slots[slot].rv), version);
+    }
+    *rv = version;
+    return slot;
+}
+
+/** Withdraw the read version of an ending transaction.
+ * @param slot Epoch slot to release
+**/
+static inline void epoch_leave(atomic_uint_fast64_t* slot) {
+    atomic_store_explicit(slot, EPOCH_FREE, memory_order_release);
+}
+
+/** Get the lowest read version any transaction may use, now or in the future.
+ * @param region Shared memory region
+ * @return Lowest read version
+**/
+static uint_fast64_t epoch_oldest(struct region* region) {
+    uint_fast64_t oldest = atomic_load(&(region->clock)); // A read version announced after the scan below is at least this version
+    size_t nbslots = atomic_load(&(region->nbslots));
+    for (size_t i = 0; i < nbslots; ++i) {
+        uint_fast64_t rv = atomic_load(&(region->slots[i].rv));
+        if (rv < oldest)
+            oldest = rv;
+    }
+    return oldest;
+}
+
+/** Free the retired segments no transaction can reach anymore.
+ * @param region Shared memory region
+**/
+static void epoch_reclaim(struct region* region) {
+    struct retired* chain = atomic_exchange(&(region->retired), NULL); // Other reclaiming transactions then find nothing to do
+    if (!chain)
+        return;
+    uint_fast64_t oldest = epoch_oldest(region);
+    struct retired* kept = NULL;
+    struct retired** tail = &kept;
+    size_t nbfreed = 0;
+    while (chain) {
+        struct retired* next = chain->next;
+        if (chain->stamp <= oldest) { // Every transaction that began before the segments were freed has ended
+            for (size_t i = 0; i < chain->size; ++i)
+                region_id_release(region, chain->ids[i]);
+            nbfreed += chain->size;
+            free(chain);
+        } else {
+            *tail = chain;
+            tail = &(chain->next);
+        }
+        chain = next;
+    }
+    atomic_fetch_sub_explicit(&(region->nbretired), nbfreed, memory_order_relaxed);
+    if (kept) { // Put back the batches still reachable
+        struct retired* top = atomic_load_explicit(&(region->retired), memory_order_relaxed);
+        do {
+            *tail = top;
+        } while (!atomic_compare_exchange_weak_explicit(&(region->retired), &top, kept, memory_order_release, memory_order_relaxed));
+    }
+}
+
+/** Retire a batch of freed segments, and reclaim the retired segments if there are enough of them.
+ * @param region Shared memory region
+ * @param batch  Batch of segments freed by a committed transaction
+**/
+static void epoch_retire(struct region* region, struct retired* batch) {
+    struct retired* top = atomic_load_explicit(&(region->retired), memory_order_relaxed);
+    do {
+        batch->next = top;
+    } while (!atomic_compare_exchange_weak_explicit(&(region->retired), &top, batch, memory_order_release, memory_order_relaxed));
+    if (atomic_fetch_add_explicit(&(region->nbretired), batch->size, memory_order_relaxed) + batch->size >= RECLAIM_BATCH)
+        epoch_reclaim(region);
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Take the write version of a committing transaction, whose write set is locked.
+ * @param region Shared memory region
+ * @param rv     Read version of the transaction
+ * @param alone  Set to whether no other transaction committed since the read version was taken (so that validation can be skipped)
+ * @return Write version, greater than the read version of every transaction that started before the write set was locked
+**/
+static inline uint_fast64_t clock_tick(struct region* region, uint_fast64_t rv, bool* alone) {
+#if defined(USE_CLOCK_GV4)
+    uint_fast64_t version = atomic_load_explicit(&(region->clock), memory_order_acquire);
+    if (likely(atomic_compare_exchange_strong_explicit(&(region->clock), &version, version + 1, memory_order_acq_rel, memory_order_acquire))) {
+        *alone = version == rv;
+        return version + 1;
+    }
+    // NOTE: The value was published after the load above, hence after the write set was locked
+    *alone = false;
+    return version;
+#elif defined(USE_CLOCK_GV5)
+    (void) rv;
+    *alone = false; // Other commits may share the clock value
+    return atomic_load_explicit(&(region->clock), memory_order_acquire) + 1;
+#else
+    uint_fast64_t wv = atomic_fetch_add_explicit(&(region->clock), 1, memory_order_acq_rel) + 1;
+    *alone = wv == rv + 1;
+    return wv;
+#endif
+}
+
+/** Make sure the clock reached a given write version, so that starting transactions can read what was written at this version.
+ * @param region Shared memory region
+ * @param wv     Write version
+**/
+static inline void clock_reach(struct region* region, uint_fast64_t wv) {
+#if defined(USE_CLOCK_GV5)
+    uint_fast64_t version = atomic_load_explicit(&(region->clock), memory_order_relaxed);
+    while (version < wv && !atomic_compare_exchange_weak_explicit(&(region->clock), &version, wv, memory_order_acq_rel, memory_order_relaxed));
+#else
+    (void) region;
+    (void) wv;
+#endif
+}
+
+/** Note that a transaction aborted, possibly on a version more recent than its read version.
+ * @param region Shared memory region
+ * @param rv     Read version of the transaction
+**/
+static inline void clock_aborted(struct region* region, uint_fast64_t rv) {
+#if defined(USE_CLOCK_GV5)
+    clock_reach(region, rv + 1); // Lazy increment, at most once per read version
+#else
+    (void) region;
+    (void) rv;
+#endif
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Causes of an abort, counted in the statistics of the thread.
+**/
+enum abort_cause {
+    ABORT_VALIDATE, // A read word is at a version more recent than the read version
+    ABORT_LOCKED,   // A word is locked by another transaction
+    ABORT_ALLOC     // A buffer of the transaction could not be allocated
+};
+
+struct cm_state {
+    size_t aborts;         // Number of consecutive aborts of the current transaction of the thread
+    uint64_t seed;         // State of the backoff pseudo-random number generator, 0 if not seeded
+    struct region* serial; // Region whose serialization token the thread holds, if any
+    size_t backoffs;       // Counters not yet added to those of the region (see 'cm_committed')
+    size_t waits;
+    size_t serials;
+#if CM_IRREVOCABLE_AFTER > 0
+    size_t irrevocables;
+#endif
+    struct tm_stats stats; // Commits and aborts of the thread (see 'tm_stats')
+};
+
+static _Thread_local struct cm_state cm = { .aborts = 0, .seed = 0, .serial = NULL, .backoffs = 0, .waits = 0, .serials = 0, .stats = { 0 } }; // Contention management state of the thread
+
+/** Pause for a "short" period of time.
+**/
+static inline void cm_pause(void) {
+#if defined(__i386__) || defined(__x86_64__)
+    _mm_pause();
+#endif
+}
+
+/** Draw a pseudo-random number for the backoffs of the thread.
+ * @return Pseudo-random number
+**/
+static inline uint64_t cm_random(void) {
+    if (unlikely(cm.seed == 0))
+        cm.seed = (uint64_t) (uintptr_t) &cm | 1; // Differs between threads
+    cm.seed ^= cm.seed << 13; // Xorshift
+    cm.seed ^= cm.seed >> 7;
+    cm.seed ^= cm.seed << 17;
+    return cm.seed;
+}
+
+/** Wait for a versioned lock to be released, for as long as the priority of the current transaction allows.
+ * @param lock Versioned lock
+ * @param word Current (locked) word
+ * @return Last word read
+**/
+static vword_t as(noinline, cold) cm_wait(vlock_t const* lock, vword_t word) { // Out of line, so that the fast paths do not compute the address of 'cm'
+#if defined(USE_CM_KARMA)
+    if (cm.aborts == 0) // Lowest priority: abort right away
+        return word;
+    ++cm.waits;
+    for (size_t budget = cm.aborts * CM_WAIT_PAUSES; budget > 0 && vword_locked(word); --budget) {
+        cm_pause();
+        word = atomic_load_explicit((vlock_t*) lock, memory_order_acquire);
+    }
+#else
+    (void) lock;
+#endif
+    return word;
+}
+
+/** Wait while another thread holds the serialization token in a state that excludes a new transaction.
+ * @param region Shared memory region
+ * @param is_ro  Whether the transaction is read-only
+**/
+static void cm_yield(struct region* region, bool is_ro) {
+#if CM_SERIALIZE_AFTER > 0 || CM_IRREVOCABLE_AFTER > 0
+    if (cm.serial == region) // Held by this thread
+        return;
+    unsigned int token;
+    while ((token = atomic_load_explicit(&(region->token), memory_order_acquire)) == TOKEN_IRREVOCABLE || (!is_ro && token == TOKEN_SERIAL))
+        sched_yield();
+#else
+    (void) region;
+    (void) is_ro;
+#endif
+}
+
+#if CM_IRREVOCABLE_AFTER > 0
+/** Take the serialization token exclusively, then wait for every running transaction to end.
+ * @param region Shared memory region
+**/
+static void as(noinline, cold) cm_irrevocable(struct region* region) {
+    if (cm.serial == region) { // Already held for serialization, no new transaction can take it
+        atomic_store(&(region->token), TOKEN_IRREVOCABLE);
+    } else {
+        unsigned int expected = TOKEN_FREE;
+        while (!atomic_compare_exchange_weak(&(region->token), &expected, TOKEN_IRREVOCABLE)) {
+            expected = TOKEN_FREE;
+            sched_yield();
+        }
+        cm.serial = region;
+    }
+    // NOTE: A transaction announcing its read version after this scan sees the token and withdraws (see 'tm_begin')
+    size_t nbslots = atomic_load(&(region->nbslots));
+    for (size_t i = 0; i < nbslots; ++i) {
+        while (atomic_load(&(region->slots[i].rv)) != EPOCH_FREE)
+            sched_yield();
+    }
+    ++cm.irrevocables;
+}
+#endif
+
+/** Apply the contention management policy before a transaction starts.
+ * @param region Shared memory region
+ * @param is_ro  Whether the transaction is read-only
+ * @return Whether the transaction must run irrevocably
+**/
+static bool cm_begin(struct region* region, bool is_ro) {
+    if (unlikely(atomic_load_explicit(&(region->token), memory_order_relaxed) != TOKEN_FREE)) // Let the token holder run (alone)
+        cm_yield(region, is_ro);
+    if (likely(cm.aborts == 0))
+        return false;
+#if defined(USE_CM_BACKOFF)
+    size_t bits = cm.aborts < CM_BACKOFF_MAX_BITS ? cm.aborts : CM_BACKOFF_MAX_BITS;
+    for (size_t pauses = cm_random() & ((1ul << bits) - 1); pauses > 0; --pauses) {
+        if ((pauses & 63) == 0) // Let a preempted conflicting transaction progress
+            sched_yield();
+        cm_pause();
+    }
+    ++cm.backoffs;
+#endif
+#if CM_IRREVOCABLE_AFTER > 0
+    if (cm.aborts >= CM_IRREVOCABLE_AFTER) { // Keeps the token until commit
+        cm_irrevocable(region);
+        return true;
+    }
+#endif
+#if CM_SERIALIZE_AFTER > 0
+    if (cm.aborts >= CM_SERIALIZE_AFTER && !cm.serial) { // Take the token, kept until commit
+        unsigned int expected = TOKEN_FREE;
+        while (!atomic_compare_exchange_weak_explicit(&(region->token), &expected, TOKEN_SERIAL, memory_order_acquire, memory_order_relaxed)) {
+            expected = TOKEN_FREE;
+            sched_yield();
+        }
+        cm.serial = region;
+        ++cm.serials;
+    }
+#endif
+    return false;
+}
+
+/** Announce the read version of a starting transaction, unless an irrevocable transaction (of another thread) got the token.
+ * @param region Shared memory region
+ * @param is_ro  Whether the transaction is read-only
+ * @param rv     Read version taken
+ * @return Epoch slot used, to release at the end of the transaction
+**/
+static inline size_t cm_enter(struct region* region, bool is_ro, uint_fast64_t* rv) {
+    while (true) {
+        size_t slot = epoch_enter(region, rv);
+        if (likely(atomic_load(&(region->token)) != TOKEN_IRREVOCABLE || cm.serial == region)) // Sequentially consistent with the scan of 'cm_irrevocable'
+            return slot;
+        epoch_leave(&(region->slots[slot].rv));
+        cm_yield(region, is_ro);
+    }
+}
+
+/** Note that the current transaction of the thread aborted.
+ * @param cause Cause of the abort
+**/
+static inline void cm_aborted(enum abort_cause cause) {
+    ++cm.aborts;
+    switch (cause) {
+    case ABORT_VALIDATE:
+        ++cm.stats.aborts_validate;
+        break;
+    case ABORT_LOCKED:
+        ++cm.stats.aborts_locked;
+        break;
+    case ABORT_ALLOC:
+        ++cm.stats.aborts_alloc;
+        break;
+    }
+}
+
+/** Forget the aborts of the current transaction of the thread, releasing the serialization token if held.
+ * @param region Shared memory region
+**/
+static inline void cm_reset(struct region* region) {
+    if (likely(cm.aborts == 0))
+        return;
+    cm.aborts = 0;
+    if (cm.serial) {
+        atomic_store_explicit(&(cm.serial->token), TOKEN_FREE, memory_order_release);
+        cm.serial = NULL;
+    }
+    if (cm.backoffs > 0) {
+        atomic_fetch_add_explicit(&(region->cm_backoffs), cm.backoffs, memory_order_relaxed);
+        cm.backoffs = 0;
+    }
+    if (cm.waits > 0) {
+        atomic_fetch_add_explicit(&(region->cm_waits), cm.waits, memory_order_relaxed);
+        cm.waits = 0;
+    }
+    if (cm.serials > 0) {
+        atomic_fetch_add_explicit(&(region->cm_serials), cm.serials, memory_order_relaxed);
+        cm.serials = 0;
+    }
+#if CM_IRREVOCABLE_AFTER > 0
+    if (cm.irrevocables > 0) {
+        atomic_fetch_add_explicit(&(region->cm_irrevocables), cm.irrevocables, memory_order_relaxed);
+        cm.irrevocables = 0;
+    }
+#endif
+}
+
+/** Note that the current transaction of the thread committed.
+ * @param region Shared memory region
+**/
+static inline void cm_committed(struct region* region) {
+    ++cm.stats.commits;
+    cm_reset(region);
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Get a transaction descriptor, without heap allocation in steady state.
+ * @return Transaction descriptor with empty sets, NULL on failure
+**/
+static struct transaction* tx_acquire(void) {
+    struct transaction* tx = tx_home;
+    if (likely(tx && !tx->busy)) {
+        tx->busy = true;
+        return tx;
+    }
+    tx = (struct transaction*) calloc(1, sizeof(struct transaction));
+    if (unlikely(!tx))
+        return NULL;
+    tx->wset.gen = 1;
+    tx->held.gen = 1;
+    if (!tx_home && tx_home_keyed && pthread_setspecific(tx_home_key, tx) == 0) // First transaction of the thread
+        tx_home = tx;
+    tx->busy = true;
+    return tx;
+}
+
+/** Release a transaction descriptor, keeping its buffers for the next transaction of the thread.
+ * @param tx Transaction to release
+**/
+static void tx_release(struct transaction* tx) {
+    epoch_leave(tx->epoch);
+    if (unlikely(tx != tx_home)) { // Concurrent transactions in the same thread
+        tx_destroy(tx);
+        return;
+    }
+    tx->rset.size   = 0;
+    tx->wset.size   = 0;
+    tx->wset.bloom  = 0;
+    tx->wset.unsorted = false;
+    if (unlikely(++(tx->wset.gen) == 0)) { // Generation wrap-around, actually empty the slots
+        if (tx->wset.index)
+            memset(tx->wset.index, 0, sizeof(struct wslot) << tx->wset.ibits);
+        tx->wset.gen = 1;
+    }
+    tx->held.size   = 0;
+    if (unlikely(++(tx->held.gen) == 0)) {
+        if (tx->held.index)
+            memset(tx->held.index, 0, sizeof(struct wslot) << tx->held.ibits);
+        tx->held.gen = 1;
+    }
+    tx->allocs.size = 0;
+    tx->frees.size  = 0;
+    tx->irrevocable = false;
+    tx->busy = false;
+}
+
+/** Release the locks held by a transaction, restoring their previous word.
+ * @param tx Transaction holding the locks
+**/
+static void tx_unlock(struct transaction* tx) {
+    for (size_t i = 0; i < tx->held.size; ++i)
+        atomic_store_explicit(tx->held.data[i].lock, tx->held.data[i].word, memory_order_release);
+    tx->held.size = 0;
+}
+
+/** Abort a transaction, undoing its speculative allocations and releasing it.
+ * @param region Shared memory region
+ * @param tx     Transaction to abort
+ * @param cause  Cause of the abort
+**/
+static void tx_abort(struct region* region, struct transaction* tx, enum abort_cause cause) {
+    cm_aborted(cause);
+    clock_aborted(region, tx->rv);
+    tx_unlock(tx);
+    for (size_t i = 0; i < tx->allocs.size; ++i) // Never reachable by other transactions
+        region_id_release(region, tx->allocs.data[i]);
+    tx_release(tx);
+}
+
+/** Hash a word address for the write set.
+ * @param addr Word address
+ * @return Hash value, top bits for the index and middle bits for the bloom filter
+**/
+static inline uint64_t wset_hash(uintptr_t addr) {
+    return (uint64_t) addr * UINT64_C(0x9e3779b97f4a7c15); // Fibonacci hashing
+}
+
+/** Get the bloom filter bit of a hashed address.
+ * @param hash Hash value
+ * @return Bloom filter bit
+**/
+static inline uint64_t wset_bloom(uint64_t hash) {
+    return UINT64_C(1) << ((hash >> 32) & 63);
+}
+
+/** Find the write set entry of a given word.
+ * @param tx   Transaction
+ * @param addr Word address
+ * @return Index of the entry, 'tx->wset.size' if not found
+**/
+static inline size_t tx_wset_find(struct transaction const* tx, uintptr_t addr) {
+    uint64_t hash = wset_hash(addr);
+    if (likely((tx->wset.bloom & wset_bloom(hash)) == 0)) // Common case: never written
+        return tx->wset.size;
+    size_t mask = (1ul << tx->wset.ibits) - 1;
+    for (size_t i = hash >> (64 - tx->wset.ibits);; i = (i + 1) & mask) {
+        struct wslot slot = tx->wset.index[i];
+        if (slot.gen != tx->wset.gen)
+            return tx->wset.size;
+        if (tx->wset.data[slot.entry].addr == addr)
+            return slot.entry;
+    }
+}
+
+/** Check whether any word of a range is in the write set.
+ * @param tx    Transaction
+ * @param addr  Address of the first word of the range
+ * @param size  Size of the range (in bytes)
+ * @param align Word size (in bytes)
+ * @return Whether some word of the range was written by the transaction
+**/
+static inline bool tx_wset_overlaps(struct transaction const* tx, uintptr_t addr, size_t size, size_t align) {
+    if (likely(tx->wset.size == 0))
+        return false;
+    for (size_t offset = 0; offset < size; offset += align) {
+        if (tx_wset_find(tx, addr + offset) < tx->wset.size)
+            return true;
+    }
+    return false;
+}
+
+/** Index a write set entry, the index having room for it.
+ * @param tx    Transaction
+ * @param entry Index of the entry to index
+**/
+static void tx_wset_index(struct transaction* tx, size_t entry) {
+    uint64_t hash = wset_hash(tx->wset.data[entry].addr);
+    size_t mask = (1ul << tx->wset.ibits) - 1;
+    size_t i = hash >> (64 - tx->wset.ibits);
+    while (tx->wset.index[i].gen == tx->wset.gen)
+        i = (i + 1) & mask;
+    tx->wset.index[i] = (struct wslot){ .entry = (uint32_t) entry, .gen = tx->wset.gen };
+    tx->wset.bloom |= wset_bloom(hash);
+}
+
+/** Make sure the write set can hold at least the given number of entries.
+ * @param tx    Transaction
+ * @param need  Required number of entries
+ * @param align Word size (in bytes)
+ * @return Whether the operation is a success
+**/
+static bool tx_wset_reserve(struct transaction* tx, size_t need, size_t align) {
+    if (unlikely(!array_reserve((void**) &(tx->wset.data), &(tx->wset.cap), need, sizeof(*(tx->wset.data)))
+              || !array_reserve((void**) &(tx->wset.values), &(tx->wset.vcap), need, align)))
+        return false;
+    if (likely(2 * need <= (1ul << tx->wset.ibits) && tx->wset.index)) // Load factor at most 1/2
+        return true;
+    size_t ibits = tx->wset.ibits > 0 ? tx->wset.ibits : 5;
+    while ((1ul << ibits) < 2 * need)
+        ++ibits;
+    if (unlikely(ibits > 32)) // Entry indices are 32-bit
+        return false;
+    struct wslot* index = (struct wslot*) calloc(1ul << ibits, sizeof(struct wslot));
+    if (unlikely(!index))
+        return false;
+    free(tx->wset.index);
+    tx->wset.index = index;
+    tx->wset.ibits = ibits;
+    tx->wset.gen   = 1;
+    for (size_t i = 0; i < tx->wset.size; ++i) // Rehash
+        tx_wset_index(tx, i);
+    return true;
+}
+
+/** Find the versioned lock word held by the transaction before it acquired it.
+ * @param tx   Transaction
+ * @param lock Versioned lock to look up
+ * @return Pointer to the word before acquisition, NULL if not held by the transaction
+**/
+static inline vword_t const* tx_held(struct transaction const* tx, vlock_t const* lock) {
+    if (tx->held.size == 0)
+        return NULL;
+    size_t mask = (1ul << tx->held.ibits) - 1;
+    for (size_t i = wset_hash((uintptr_t) lock) >> (64 - tx->held.ibits);; i = (i + 1) & mask) {
+        struct wslot slot = tx->held.index[i];
+        if (slot.gen != tx->held.gen)
+            return NULL;
+        if (tx->held.data[slot.entry].lock == lock)
+            return &(tx->held.data[slot.entry].word);
+    }
+}
+
+/** Index a held lock entry, the index having room for it.
+ * @param tx    Transaction
+ * @param entry Index of the entry to index
+**/
+static void tx_held_index(struct transaction* tx, size_t entry) {
+    size_t mask = (1ul << tx->held.ibits) - 1;
+    size_t i = wset_hash((uintptr_t) tx->held.data[entry].lock) >> (64 - tx->held.ibits);
+    while (tx->held.index[i].gen == tx->held.gen)
+        i = (i + 1) & mask;
+    tx->held.index[i] = (struct wslot){ .entry = (uint32_t) entry, .gen = tx->held.gen };
+}
+
+/** Make sure the transaction can hold at least the given number of locks.
+ * @param tx   Transaction
+ * @param need Required number of entries
+ * @return Whether the operation is a success
+**/
+static bool tx_held_reserve(struct transaction* tx, size_t need) {
+    if (unlikely(!array_reserve((void**) &(tx->held.data), &(tx->held.cap), need, sizeof(*(tx->held.data)))))
+        return false;
+    if (likely(2 * need <= (1ul << tx->held.ibits) && tx->held.index)) // Load factor at most 1/2
+        return true;
+    size_t ibits = tx->held.ibits > 0 ? tx->held.ibits : 5;
+    while ((1ul << ibits) < 2 * need)
+        ++ibits;
+    if (unlikely(ibits > 32)) // Entry indices are 32-bit
+        return false;
+    struct wslot* index = (struct wslot*) calloc(1ul << ibits, sizeof(struct wslot));
+    if (unlikely(!index))
+        return false;
+    free(tx->held.index);
+    tx->held.index = index;
+    tx->held.ibits = ibits;
+    tx->held.gen   = 1;
+    for (size_t i = 0; i < tx->held.size; ++i) // Rehash
+        tx_held_index(tx, i);
+    return true;
+}
+
+/** Compare two write set entries by address, for 'qsort_r'.
+ * @param a    Index of the first entry
+ * @param b    Index of the second entry
+ * @param data Write set entries
+ * @return Negative, zero or positive if the first address is lower, equal or higher
+**/
+static int wset_compare(void const* a, void const* b, void* data) {
+    uintptr_t x = ((struct wentry const*) data)[*(uint32_t const*) a].addr;
+    uintptr_t y = ((struct wentry const*) data)[*(uint32_t const*) b].addr;
+    return (x > y) - (x < y);
+}
+
+/** Order the write set entries by address, for the commit.
+ * @param tx Committing transaction
+ * @return Whether the operation is a success
+**/
+static bool tx_wset_sort(struct transaction* tx) {
+    if (likely(!tx->wset.unsorted)) // Inserted in order (e.g. a transaction writing a whole array)
+        return true;
+    size_t size = tx->wset.size;
+    if (unlikely(!array_reserve((void**) &(tx->wset.order), &(tx->wset.ocap), size, sizeof(*(tx->wset.order)))))
+        return false;
+    uint32_t* order = tx->wset.order;
+    struct wentry const* data = tx->wset.data;
+    if (size <= COMMIT_SORT_INSERTION) {
+        for (size_t i = 0; i < size; ++i) {
+            size_t j = i;
+            for (; j > 0 && data[order[j - 1]].addr > data[i].addr; --j)
+                order[j] = order[j - 1];
+            order[j] = (uint32_t) i;
+        }
+    } else {
+        for (size_t i = 0; i < size; ++i)
+            order[i] = (uint32_t) i;
+        qsort_r(order, size, sizeof(*order), wset_compare, (void*) data);
+    }
+    return true;
+}
+
+/** Get the write set entry of a given rank by address, once sorted.
+ * @param tx   Committing transaction
+ * @param rank Rank of the entry
+ * @return Index of the entry
+**/
+static inline size_t tx_wset_nth(struct transaction const* tx, size_t rank) {
+    return unlikely(tx->wset.unsorted) ? tx->wset.order[rank] : rank;
+}
+
+/** Acquire a versioned lock for the commit of a transaction.
+ * @param tx   Committing transaction
+ * @param lock Versioned lock to acquire
+ * @return Whether the lock is now held by the transaction
+**/
+static bool tx_lock(struct transaction* tx, vlock_t* lock) {
+    vword_t word = atomic_load_explicit(lock, memory_order_relaxed);
+    if (vword_locked(word)) {
+        if (tx_held(tx, lock))
+            return true;
+        word = cm_wait(lock, word);
+        if (vword_locked(word))
+            return false;
+    }
+    if (unlikely(!atomic_compare_exchange_strong_explicit(lock, &word, word | 1, memory_order_acquire, memory_order_relaxed)))
+        return false;
+    tx->held.data[tx->held.size] = (struct acquired){ .lock = lock, .word = word };
+    tx_held_index(tx, tx->held.size++);
+    return true;
+}
+
+/** Check that every stripe of a range is unlocked and at a version no greater than the read version.
+ * @param locks  Versioned lock table
+ * @param index  Index of the versioned lock of the first stripe of the range
+ * @param count  Number of stripes in the range
+ * @param rv     Read version
+ * @return Whether every word of the range satisfies the condition
+**/
+static inline bool range_valid(vlock_t const* locks, size_t index, size_t count, uint_fast64_t rv) {
+    for (size_t stop = index + count; index < stop; ++index) {
+        vword_t word = atomic_load_explicit(lock_at(locks, index), memory_order_acquire);
+        if (unlikely(vword_locked(word)))
+            word = cm_wait(lock_at(locks, index), word);
+        if (unlikely(vword_locked(word) || vword_version(word) > rv))
+            return false;
+    }
+    return true;
+}
+
+/** Check whether a stripe of a range is locked, to tell the cause of a failed 'range_valid'.
+ * @param locks Versioned lock table
+ * @param index Index of the versioned lock of the first stripe of the range
+ * @param count Number of stripes in the range
+ * @return Whether a word of the range is locked
+**/
+static bool as(cold) range_locked(vlock_t const* locks, size_t index, size_t count) {
+    for (size_t stop = index + count; index < stop; ++index) {
+        if (vword_locked(atomic_load_explicit(lock_at(locks, index), memory_order_relaxed)))
+            return true;
+    }
+    return false;
+}
+
+/** Validate a range of the read set of a committing transaction, one entry at a time.
+ * @param tx    Transaction to validate
+ * @param first Index of the first entry to validate
+ * @param stop  Index of the entry following the last one to validate
+ * @return Whether every read word of the range is still at a version no greater than the read version
+**/
+static bool rset_valid_scalar(struct transaction const* tx, size_t first, size_t stop) {
+    for (size_t i = first; i < stop; ++i) {
+        vword_t word = atomic_load_explicit(tx->rset.data[i], memory_order_acquire);
+        if (vword_locked(word)) {
+            vword_t const* held = tx_held(tx, tx->rset.data[i]);
+            if (!held)
+                return false;
+            word = *held;
+        }
+        if (vword_version(word) > tx->rv)
+            return false;
+    }
+    return true;
+}
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(USE_RSET_SCALAR)
+
+// NOTE: The vector kernels read the versioned locks with plain (vector) loads, ordered after the clock update of the commit by the compiler and, on x86, by the hardware.
+//       A word is valid if unlocked at a version no greater than 'rv', i.e. if it is even and not greater than 'rv << 1' (as a signed integer, versions being 62-bit at most).
+//       Blocks with an invalid word are re-checked by the scalar loop, as the word may be locked by the committing transaction itself.
+
+/** Validate a range of the read set of a committing transaction, eight entries at a time with AVX2 gathers.
+ * @param tx    Transaction to validate
+ * @param first Index of the first entry to validate
+ * @param stop  Index of the entry following the last one to validate
+ * @return Whether every read word of the range is still at a version no greater than the read version
+**/
+static bool as(target("avx2")) rset_valid_avx2(struct transaction const* tx, size_t first, size_t stop) {
+    vlock_t* const* data = tx->rset.data;
+    __m256i const limit = _mm256_set1_epi64x((long long) vword_make(tx->rv));
+    size_t i = first;
+    for (; i + 8 <= stop; i += 8) {
+        __m256i words0 = _mm256_i64gather_epi64((long long const*) 0, _mm256_loadu_si256((__m256i const*) (data + i)), 1);
+        __m256i words1 = _mm256_i64gather_epi64((long long const*) 0, _mm256_loadu_si256((__m256i const*) (data + i + 4)), 1);
+        __m256i bad = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpgt_epi64(words0, limit), _mm256_slli_epi64(words0, 63)),
+            _mm256_or_si256(_mm256_cmpgt_epi64(words1, limit), _mm256_slli_epi64(words1, 63)));
+        if (unlikely(!_mm256_testz_si256(bad, bad)) && !rset_valid_scalar(tx, i, i + 8))
+            return false;
+    }
+    return rset_valid_scalar(tx, i, stop);
+}
+
+/** Validate a range of the read set of a committing transaction, four entries at a time with SSE4.2 comparisons.
+ * @param tx    Transaction to validate
+ * @param first Index of the first entry to validate
+ * @param stop  Index of the entry following the last one to validate
+ * @return Whether every read word of the range is still at a version no greater than the read version
+**/
+static bool as(target("sse4.2")) rset_valid_sse42(struct transaction const* tx, size_t first, size_t stop) {
+    vlock_t* const* data = tx->rset.data;
+    __m128i const limit = _mm_set1_epi64x((long long) vword_make(tx->rv));
+    size_t i = first;
+    for (; i + 4 <= stop; i += 4) {
+        __m128i words0 = _mm_set_epi64x((long long) atomic_load_explicit(data[i + 1], memory_order_relaxed), (long long) atomic_load_explicit(data[i], memory_order_relaxed));
+        __m128i words1 = _mm_set_epi64x((long long) atomic_load_explicit(data[i + 3], memory_order_relaxed), (long long) atomic_load_explicit(data[i + 2], memory_order_relaxed));
+        __m128i bad = _mm_or_si128(
+            _mm_or_si128(_mm_cmpgt_epi64(words0, limit), _mm_slli_epi64(words0, 63)),
+            _mm_or_si128(_mm_cmpgt_epi64(words1, limit), _mm_slli_epi64(words1, 63)));
+        if (unlikely(!_mm_testz_si128(bad, bad)) && !rset_valid_scalar(tx, i, i + 4))
+            return false;
+    }
+    return rset_valid_scalar(tx, i, stop);
+}
+
+#endif
+
+/** Read set validation kernel, chosen for the running CPU (see 'rset_setup').
+**/
+static bool (*rset_valid)(struct transaction const*, size_t, size_t) = rset_valid_scalar;
+
+/** Choose the read set validation kernel for the running CPU.
+**/
+static void as(constructor) rset_setup(void) {
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(USE_RSET_SCALAR)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        rset_valid = rset_valid_avx2;
+    } else if (__builtin_cpu_supports("sse4.2")) {
+        rset_valid = rset_valid_sse42;
+    }
+#endif
+}
+
+/** Validate the read set of a committing transaction.
+ * @param tx Transaction to validate
+ * @return Whether every read word is still at a version no greater than the read version
+**/
+static bool tx_validate(struct transaction const* tx) {
+    if (tx->rset.size < RSET_VECTOR_MIN) // Not worth an indirect call
+        return rset_valid_scalar(tx, 0, tx->rset.size);
+    return rset_valid(tx, 0, tx->rset.size);
+}
+
 // -------------------------------------------------------------------------- //
 
 /** Create (i.e. allocate + init) a new shared memory region, with one first non-free-able allocated segment of the requested size and alignment.
@@ -70,43 +1643,110 @@
  * @param align Alignment (in bytes, must be a power of 2) that the shared memory region must support
  * @return Opaque shared memory region handle, 'invalid_shared' on failure
 **/
-shared_t tm_create(size_t size as(unused), size_t align as(unused)) {
-    // TODO: tm_create(size_t, size_t)
-    return invalid_shared;
+shared_t tm_create(size_t size, size_t align) {
+    if (unlikely(size >= (UINTMAX_C(1) << SEGMENT_OFFSET_BITS)))
+        return invalid_shared;
+    struct region* region = (struct region*) aligned_alloc(_Alignof(struct region), sizeof(struct region));
+    if (unlikely(!region))
+        return invalid_shared;
+    region->align_alloc  = align < sizeof(void*) ? sizeof(void*) : align; // Also satisfy 'posix_memalign' requirement
+    region->word_shift   = __builtin_ctzl(align);
+    region->stripe_shift = region->word_shift > LOCK_STRIPE_BITS ? region->word_shift : LOCK_STRIPE_BITS;
+    pthread_once(&zero_once, zero_start);
+    void* base = slab_get(region, size);
+    if (unlikely(!base)) {
+        free(region);
+        return invalid_shared;
+    }
+    region->locks = (vlock_t*) mmap(NULL, LOCK_TABLE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0); // Page-aligned and zeroed
+    if (unlikely(region->locks == MAP_FAILED)) {
+        slab_put(region, base, size);
+        free(region);
+        return invalid_shared;
+    }
+    region->segments = (struct segment*) calloc(1ul << SEGMENT_ID_BITS, sizeof(struct segment));
+    if (unlikely(!region->segments)) {
+        munmap(region->locks, LOCK_TABLE_SIZE);
+        slab_put(region, base, size);
+        free(region);
+        return invalid_shared;
+    }
+    region->slots = (struct epoch_slot*) aligned_alloc(sizeof(struct epoch_slot), sizeof(struct epoch_slot) << EPOCH_SLOT_BITS);
+    if (unlikely(!region->slots)) {
+        free(region->segments);
+        munmap(region->locks, LOCK_TABLE_SIZE);
+        slab_put(region, base, size);
+        free(region);
+        return invalid_shared;
+    }
+    for (size_t i = 0; i < (1ul << EPOCH_SLOT_BITS); ++i)
+        atomic_init(&(region->slots[i].rv), EPOCH_FREE);
+    region->segments[1] = (struct segment){ .base = (char*) base, .size = size, .locks = 0 };
+    atomic_init(&(region->next_id), 2);
+    atomic_init(&(region->next_lock), region_stripes(region, size));
+    atomic_init(&(region->free_ids), 0);
+    atomic_init(&(region->retired), NULL);
+    atomic_init(&(region->nbretired), 0);
+    atomic_init(&(region->nbslots), 0);
+    atomic_init(&(region->token), TOKEN_FREE);
+    atomic_init(&(region->cm_backoffs), 0);
+    atomic_init(&(region->cm_waits), 0);
+    atomic_init(&(region->cm_serials), 0);
+    atomic_init(&(region->cm_irrevocables), 0);
+    atomic_init(&(region->clock), 0);
+    region->start       = (void*) addr_make(1, 0);
+    region->size        = size;
+    region->align       = align;
+    return region;
 }
 
 /** Destroy (i.e. clean-up + free) a given shared memory region.
  * @param shared Shared memory region to destroy, with no running transaction
 **/
-void tm_destroy(shared_t shared as(unused)) {
-    // TODO: tm_destroy(shared_t)
+void tm_destroy(shared_t shared) {
+    struct region* region = (struct region*) shared;
+#if defined(USE_CM_REPORT)
+    fprintf(stderr, "tm: %zu backoff(s), %zu wait(s), %zu serialization(s), %zu irrevocable transaction(s)\n", atomic_load(&(region->cm_backoffs)), atomic_load(&(region->cm_waits)), atomic_load(&(region->cm_serials)), atomic_load(&(region->cm_irrevocables)));
+#endif
+    size_t next_id = atomic_load_explicit(&(region->next_id), memory_order_relaxed);
+    for (size_t id = 1; id < next_id; ++id) { // Free every segment, including the retired ones
+        if (region->segments[id].base)
+            slab_put(region, region->segments[id].base, region->segments[id].size);
+    }
+    struct retired* chain = atomic_load_explicit(&(region->retired), memory_order_relaxed);
+    while (chain) {
+        struct retired* next = chain->next;
+        free(chain);
+        chain = next;
+    }
+    free(region->slots);
+    free(region->segments);
+    munmap(region->locks, LOCK_TABLE_SIZE);
+    free(region);
 }
 
 /** [thread-safe] Return the start address of the first allocated segment in the shared memory region.
  * @param shared Shared memory region to query
  * @return Start address of the first allocated segment
 **/
-void* tm_start(shared_t shared as(unused)) {
-    // TODO: tm_start(shared_t)
-    return NULL;
+void* tm_start(shared_t shared) {
+    return ((struct region*) shared)->start;
 }
 
 /** [thread-safe] Return the size (in bytes) of the first allocated segment of the shared memory region.
  * @param shared Shared memory region to query
  * @return First allocated segment size
 **/
-size_t tm_size(shared_t shared as(unused)) {
-    // TODO: tm_size(shared_t)
-    return 0;
+size_t tm_size(shared_t shared) {
+    return ((struct region*) shared)->size;
 }
 
 /** [thread-safe] Return the alignment (in bytes) of the memory accesses on the given shared memory region.
  * @param shared Shared memory region to query
  * @return Alignment used globally
 **/
-size_t tm_align(shared_t shared as(unused)) {
-    // TODO: tm_align(shared_t)
-    return 0;
+size_t tm_align(shared_t shared) {
+    return ((struct region*) shared)->align;
 }
 
 /** [thread-safe] Begin a new transaction on the given shared memory region.
@@ -114,9 +1754,47 @@ size_t tm_align(shared_t shared as(unused)) {
  * @param is_ro  Whether the transaction is read-only
  * @return Opaque transaction ID, 'invalid_tx' on failure
 **/
-tx_t tm_begin(shared_t shared as(unused), bool is_ro as(unused)) {
-    // TODO: tm_begin(shared_t)
-    return invalid_tx;
+tx_t tm_begin(shared_t shared, bool is_ro) {
+    struct region* region = (struct region*) shared;
+    uint_fast64_t rv;
+    bool irrevocable = cm_begin(region, is_ro);
+    if (is_ro && likely(!irrevocable)) {
+        size_t slot = cm_enter(region, is_ro, &rv);
+        return tx_make_ro(rv, slot);
+    }
+    struct transaction* tx = tx_acquire();
+    if (unlikely(!tx)) {
+        if (unlikely(irrevocable)) // Let the other transactions run
+            cm_reset(region);
+        return invalid_tx;
+    }
+    tx->epoch = &(region->slots[cm_enter(region, is_ro, &rv)].rv);
+    tx->rv = rv;
+    tx->irrevocable = irrevocable;
+    return (tx_t) tx;
+}
+
+/** Commit an irrevocable transaction, whose writes are already in place.
+ * @param region Shared memory region
+ * @param tx     Irrevocable transaction
+ * @return Whether the transaction committed (always true)
+**/
+static bool as(noinline, cold) tx_end_irrevocable(struct region* region, struct transaction* tx) {
+    struct retired* batch = NULL;
+    if (tx->frees.size > 0) { // No transaction ran, the segments can be reclaimed as soon as the token is released
+        batch = (struct retired*) malloc(sizeof(struct retired) + tx->frees.size * sizeof(*(batch->ids)));
+        if (likely(batch)) { // Otherwise the segments are freed with the region
+            batch->stamp = atomic_load(&(region->clock));
+            batch->size  = tx->frees.size;
+            memcpy(batch->ids, tx->frees.data, tx->frees.size * sizeof(*(batch->ids)));
+        }
+    }
+    // NOTE: Transactions starting after the token is released read the written words with a read version not lower than their version
+    tx_release(tx);
+    cm_committed(region);
+    if (batch)
+        epoch_retire(region, batch);
+    return true;
 }
 
 /** [thread-safe] End the given transaction.
@@ -124,9 +1802,99 @@ tx_t tm_begin(shared_t shared as(unused), bool is_ro as(unused)) {
  * @param tx     Transaction to end
  * @return Whether the whole transaction committed
 **/
-bool tm_end(shared_t shared as(unused), tx_t tx as(unused)) {
-    // TODO: tm_end(shared_t, tx_t)
-    return false;
+bool tm_end(shared_t shared, tx_t tx) {
+    struct region* region = (struct region*) shared;
+    if (tx_is_ro(tx)) { // Every read was consistent with the read version
+        epoch_leave(&(region->slots[tx_ro_slot(tx)].rv));
+        cm_committed(region);
+        return true;
+    }
+    struct transaction* t = (struct transaction*) tx;
+    if (unlikely(t->irrevocable)) // Everything is already in place
+        return tx_end_irrevocable(region, t);
+    if (t->wset.size == 0 && t->frees.size == 0) { // Every read was consistent with the read version
+        tx_release(t);
+        cm_committed(region);
+        return true;
+    }
+    // Lock the write set in address order (then the freed segments, so that concurrent readers notice)
+    size_t nblocks = t->wset.size;
+    for (size_t i = 0; i < t->frees.size; ++i)
+        nblocks += region_stripes(region, region->segments[t->frees.data[i]].size);
+    if (unlikely(!tx_held_reserve(t, nblocks) || !tx_wset_sort(t))) {
+        tx_abort(region, t, ABORT_ALLOC);
+        return false;
+    }
+    vlock_t* last = NULL;
+    for (size_t i = 0; i < t->wset.size; ++i) {
+        if (i + COMMIT_PREFETCH_DISTANCE < t->wset.size) { // Overlap the cache misses of the next entries with this one
+            struct wentry const* next = &(t->wset.data[tx_wset_nth(t, i + COMMIT_PREFETCH_DISTANCE)]);
+            prefetch_write(next->lock);
+            prefetch_write(region_translate(region, next->addr));
+        }
+        vlock_t* lock = t->wset.data[tx_wset_nth(t, i)].lock;
+        if (lock == last) // Same stripe as the previous word
+            continue;
+        if (unlikely(!tx_lock(t, lock))) {
+            tx_abort(region, t, ABORT_LOCKED);
+            return false;
+        }
+        last = lock;
+    }
+    for (size_t i = 0; i < t->frees.size; ++i) {
+        size_t index = region->segments[t->frees.data[i]].locks;
+        size_t stop  = index + region_stripes(region, region->segments[t->frees.data[i]].size);
+        for (; index < stop; ++index) {
+            if (unlikely(!tx_lock(t, region_lock_at(region, index)))) {
+                tx_abort(region, t, ABORT_LOCKED);
+                return false;
+            }
+        }
+    }
+    // Take the write version, validate the read set if someone committed in between
+    bool alone;
+    uint_fast64_t wv = clock_tick(region, t->rv, &alone);
+    if (!alone && unlikely(!tx_validate(t))) {
+        tx_abort(region, t, ABORT_VALIDATE);
+        return false;
+    }
+    struct retired* batch = NULL;
+    if (unlikely(t->frees.size > 0)) { // Prepare the batch of segments to retire
+        batch = (struct retired*) malloc(sizeof(struct retired) + t->frees.size * sizeof(*(batch->ids)));
+        if (unlikely(!batch)) { // Still possible to abort, nothing was written back
+            tx_abort(region, t, ABORT_ALLOC);
+            return false;
+        }
+        batch->stamp = wv;
+        batch->size  = t->frees.size;
+        memcpy(batch->ids, t->frees.data, t->frees.size * sizeof(*(batch->ids)));
+    }
+    // Write back, one copy per run of words contiguous both in shared memory and in the buffer, and release the locks with the new version
+    size_t align = region->align;
+    for (size_t i = 0; i < t->wset.size;) {
+        size_t first = tx_wset_nth(t, i);
+        uintptr_t addr = t->wset.data[first].addr;
+        size_t count = 1;
+        while (i + count < t->wset.size) {
+            size_t entry = tx_wset_nth(t, i + count);
+            if (entry != first + count || t->wset.data[entry].addr != addr + count * align)
+                break;
+            ++count;
+        }
+        memcpy(region_translate(region, addr), t->wset.values + first * align, count * align);
+        i += count;
+    }
+    vword_t word = vword_make(wv);
+    for (size_t i = 0; i < t->held.size; ++i)
+        atomic_store_explicit(t->held.data[i].lock, word, memory_order_release);
+    // NOTE: Allocated segments are published through the written addresses
+    tx_release(t);
+    cm_committed(region);
+    if (unlikely(batch)) { // After leaving the epoch, as this transaction does not prevent reclaiming its own batch
+        clock_reach(region, wv); // The batch can only be reclaimed once the clock passed its stamp
+        epoch_retire(region, batch);
+    }
+    return true;
 }
 
 /** [thread-safe] Read operation in the given transaction, source in the shared region and target in a private region.
@@ -137,9 +1905,87 @@ bool tm_end(shared_t shared as(unused), tx_t tx as(unused)) {
  * @param target Target start address (in a private region)
  * @return Whether the whole transaction can continue
 **/
-bool tm_read(shared_t shared as(unused), tx_t tx as(unused), void const* source as(unused), size_t size as(unused), void* target as(unused)) {
-    // TODO: tm_read(shared_t, tx_t, void const*, size_t, void*)
-    return false;
+bool tm_read(shared_t shared, tx_t tx, void const* source, size_t size, void* target) {
+    struct region* region = (struct region*) shared;
+    if (tx_is_ro(tx)) { // Check the versions before and after copying the whole range
+        uint_fast64_t rv = tx_ro_rv(tx);
+        vlock_t const* locks = region->locks;
+        size_t index = region_lock_index(region, (uintptr_t) source);
+        size_t count = region_lock_index(region, (uintptr_t) source + size - region->align) - index + 1;
+        if (likely(range_valid(locks, index, count, rv))) {
+            memcpy(target, region_translate(region, (uintptr_t) source), size);
+            atomic_thread_fence(memory_order_acquire);
+            if (likely(range_valid(locks, index, count, rv)))
+                return true;
+        }
+        epoch_leave(&(region->slots[tx_ro_slot(tx)].rv)); // The transaction ends here
+        cm_aborted(range_locked(locks, index, count) ? ABORT_LOCKED : ABORT_VALIDATE);
+        clock_aborted(region, rv);
+        return false;
+    }
+    struct transaction* t = (struct transaction*) tx;
+    if (unlikely(t->irrevocable)) { // Alone, read in place
+        memcpy(target, region_translate(region, (uintptr_t) source), size);
+        return true;
+    }
+    size_t align = region->align;
+    char const* src = (char const*) region_translate(region, (uintptr_t) source);
+    size_t locks = region->segments[addr_id((uintptr_t) source)].locks;
+    size_t start = addr_offset((uintptr_t) source);
+    if (likely(!tx_wset_overlaps(t, (uintptr_t) source, size, align))) { // One copy, check and read set entry per stripe
+        size_t shift = region->stripe_shift;
+        size_t first = start >> shift;
+        size_t last  = (start + size - 1) >> shift;
+        if (unlikely(!array_reserve((void**) &(t->rset.data), &(t->rset.cap), t->rset.size + (last - first + 1), sizeof(*(t->rset.data))))) {
+            tx_abort(region, t, ABORT_ALLOC);
+            return false;
+        }
+        for (size_t stripe = first; stripe <= last; ++stripe) {
+            size_t from = stripe == first ? 0 : (stripe << shift) - start;
+            size_t to   = stripe == last ? size : ((stripe + 1) << shift) - start;
+            vlock_t* lock = region_lock_at(region, locks + stripe);
+            vword_t before = atomic_load_explicit(lock, memory_order_acquire);
+            if (unlikely(vword_locked(before)))
+                before = cm_wait(lock, before);
+            memcpy((char*) target + from, src + from, to - from);
+            atomic_thread_fence(memory_order_acquire);
+            vword_t after = atomic_load_explicit(lock, memory_order_relaxed);
+            if (unlikely(vword_locked(before) || before != after || vword_version(before) > t->rv)) {
+                tx_abort(region, t, vword_locked(before) || vword_locked(after) ? ABORT_LOCKED : ABORT_VALIDATE);
+                return false;
+            }
+            if (t->rset.size == 0 || t->rset.data[t->rset.size - 1] != lock) // Consecutive ranges of the same stripe share one entry
+                t->rset.data[t->rset.size++] = lock;
+        }
+        return true;
+    }
+    if (unlikely(!array_reserve((void**) &(t->rset.data), &(t->rset.cap), t->rset.size + (size >> region->word_shift), sizeof(*(t->rset.data))))) {
+        tx_abort(region, t, ABORT_ALLOC);
+        return false;
+    }
+    for (size_t offset = 0; offset < size; offset += align) {
+        uintptr_t addr = (uintptr_t) source + offset;
+        void* dst = (char*) target + offset;
+        size_t pos = tx_wset_find(t, addr);
+        if (pos < t->wset.size) { // Read-after-write
+            memcpy(dst, t->wset.values + pos * align, align);
+            continue;
+        }
+        vlock_t* lock = region_lock_at(region, locks + ((start + offset) >> region->stripe_shift));
+        vword_t before = atomic_load_explicit(lock, memory_order_acquire);
+        if (unlikely(vword_locked(before)))
+            before = cm_wait(lock, before);
+        memcpy(dst, src + offset, align);
+        atomic_thread_fence(memory_order_acquire);
+        vword_t after = atomic_load_explicit(lock, memory_order_relaxed);
+        if (unlikely(vword_locked(before) || before != after || vword_version(before) > t->rv)) {
+            tx_abort(region, t, vword_locked(before) || vword_locked(after) ? ABORT_LOCKED : ABORT_VALIDATE);
+            return false;
+        }
+        if (t->rset.size == 0 || t->rset.data[t->rset.size - 1] != lock) // Words of the same stripe share one entry
+            t->rset.data[t->rset.size++] = lock;
+    }
+    return true;
 }
 
 /** [thread-safe] Write operation in the given transaction, source in a private region and target in the shared region.
@@ -150,9 +1996,35 @@ bool tm_read(shared_t shared as(unused), tx_t tx as(unused), void const* source
  * @param target Target start address (in the shared region)
  * @return Whether the whole transaction can continue
 **/
-bool tm_write(shared_t shared as(unused), tx_t tx as(unused), void const* source as(unused), size_t size as(unused), void* target as(unused)) {
-    // TODO: tm_write(shared_t, tx_t, void const*, size_t, void*)
-    return false;
+bool tm_write(shared_t shared, tx_t tx, void const* source, size_t size, void* target) {
+    struct region* region = (struct region*) shared;
+    struct transaction* t = (struct transaction*) tx;
+    if (unlikely(t->irrevocable)) { // Alone, write in place
+        // NOTE: Neither the stripe versions nor the clock move, which is only correct because 'cm_irrevocable' drained every epoch slot and 'cm_enter' keeps new transactions out until the token is released: no transaction can observe a partial write, and any later one has a read version not lower than every stripe version
+        memcpy(region_translate(region, (uintptr_t) target), source, size);
+        return true;
+    }
+    size_t align = region->align;
+    if (unlikely(!tx_wset_reserve(t, t->wset.size + (size >> region->word_shift), align))) {
+        tx_abort(region, t, ABORT_ALLOC);
+        return false;
+    }
+    size_t locks = region->segments[addr_id((uintptr_t) target)].locks;
+    size_t start = addr_offset((uintptr_t) target);
+    t->logged += size;
+    for (size_t offset = 0; offset < size; offset += align) {
+        uintptr_t addr = (uintptr_t) target + offset;
+        size_t pos = tx_wset_find(t, addr);
+        if (pos == t->wset.size) { // New entry
+            t->wset.data[pos] = (struct wentry){ .addr = addr, .lock = region_lock_at(region, locks + ((start + offset) >> region->stripe_shift)) };
+            tx_wset_index(t, pos);
+            if (pos > 0 && addr < t->wset.data[pos - 1].addr)
+                t->wset.unsorted = true;
+            ++(t->wset.size);
+        }
+        memcpy(t->wset.values + pos * align, (char const*) source + offset, align);
+    }
+    return true;
 }
 
 /** [thread-safe] Memory allocation in the given transaction.
@@ -162,9 +2034,25 @@ bool tm_write(shared_t shared as(unused), tx_t tx as(unused), void const* source
  * @param target Pointer in private memory receiving the address of the first byte of the newly allocated, aligned segment
  * @return Whether the whole transaction can continue (success/nomem), or not (abort_alloc)
 **/
-alloc_t tm_alloc(shared_t shared as(unused), tx_t tx as(unused), size_t size as(unused), void** target as(unused)) {
-    // TODO: tm_alloc(shared_t, tx_t, size_t, void**)
-    return abort_alloc;
+alloc_t tm_alloc(shared_t shared, tx_t tx, size_t size, void** target) {
+    struct region* region = (struct region*) shared;
+    struct transaction* t = (struct transaction*) tx;
+    if (unlikely(size >= (UINTMAX_C(1) << SEGMENT_OFFSET_BITS)
+              || !array_reserve((void**) &(t->allocs.data), &(t->allocs.cap), t->allocs.size + 1, sizeof(*(t->allocs.data)))))
+        return nomem_alloc;
+    size_t id = region_id_acquire(region);
+    if (unlikely(id == 0)) // Segment table full
+        return nomem_alloc;
+    void* base = slab_get(region, size);
+    if (unlikely(!base)) { // Allocation failed
+        region_id_release(region, id);
+        return nomem_alloc;
+    }
+    size_t locks = atomic_fetch_add_explicit(&(region->next_lock), region_stripes(region, size), memory_order_relaxed);
+    region->segments[id] = (struct segment){ .base = (char*) base, .size = size, .locks = locks };
+    t->allocs.data[t->allocs.size++] = id;
+    *target = (void*) addr_make(id, 0);
+    return success_alloc;
 }
 
 /** [thread-safe] Memory freeing in the given transaction.
@@ -173,7 +2061,25 @@ alloc_t tm_alloc(shared_t shared as(unused), tx_t tx as(unused), size_t size as(
  * @param target Address of the first byte of the previously allocated segment to deallocate
  * @return Whether the whole transaction can continue
 **/
-bool tm_free(shared_t shared as(unused), tx_t tx as(unused), void* target as(unused)) {
-    // TODO: tm_free(shared_t, tx_t, void*)
-    return false;
+bool tm_free(shared_t shared, tx_t tx, void* target) {
+    struct region* region = (struct region*) shared;
+    struct transaction* t = (struct transaction*) tx;
+    if (unlikely(!array_reserve((void**) &(t->frees.data), &(t->frees.cap), t->frees.size + 1, sizeof(*(t->frees.data))))) {
+        if (unlikely(t->irrevocable)) // Cannot abort, the segment is freed with the region instead
+            return true;
+        tx_abort(region, t, ABORT_ALLOC);
+        return false;
+    }
+    // NOTE: A segment allocated by this very transaction is published then retired at commit (see 'tm_end'), or freed on abort
+    t->frees.data[t->frees.size++] = addr_id((uintptr_t) target);
+    return true;
+}
+
+/** [thread-safe] Get the statistics of the calling thread.
+ * @param shared Shared memory region (the counters of a thread cover every region it ran transactions on)
+ * @param stats  Statistics to fill
+**/
+void tm_stats(shared_t shared as(unused), struct tm_stats* stats) {
+    *stats = cm.stats;
+    stats->bytes_logged = tx_home ? tx_home->logged : 0;
 }